@@ -0,0 +1,87 @@
+#include <lvgl.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <drivers/display/st7789v.h>
+
+#include <zmk/display.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/layer_state_changed.h>
+
+#include "ambient_mode.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static const struct device *display = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+
+static lv_obj_t *ambient_screen;
+static bool ambient;
+
+// Scan only the rows covered by the screen's widgets, in 8 colours
+static void ambient_mode_enter_work_cb(struct k_work *work) {
+    lv_area_t area;
+    lv_area_t coords;
+    bool found = false;
+
+    for (uint32_t i = 0; i < lv_obj_get_child_cnt(ambient_screen); i++) {
+        lv_obj_t *child = lv_obj_get_child(ambient_screen, i);
+
+        if (lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN)) {
+            continue;
+        }
+
+        lv_obj_get_coords(child, &coords);
+        if (found) {
+            _lv_area_join(&area, &area, &coords);
+        } else {
+            lv_area_copy(&area, &coords);
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return;
+    }
+
+    LOG_DBG("Entering ambient mode");
+    st7789v_set_partial_area(display, MAX(area.x1, 0), MAX(area.y1, 0),
+                             lv_area_get_width(&area), lv_area_get_height(&area));
+    st7789v_set_idle_mode(display, true);
+    ambient = true;
+}
+
+static void ambient_mode_exit_work_cb(struct k_work *work) {
+    if (ambient) {
+        LOG_DBG("Leaving ambient mode");
+        st7789v_set_idle_mode(display, false);
+        st7789v_set_partial_area(display, 0, 0, 0, 0);
+        ambient = false;
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(ambient_mode_enter_work, ambient_mode_enter_work_cb);
+static K_WORK_DEFINE(ambient_mode_exit_work, ambient_mode_exit_work_cb);
+
+static void ambient_mode_restart_timeout(void) {
+    k_work_reschedule_for_queue(zmk_display_work_q(), &ambient_mode_enter_work,
+                                K_SECONDS(CONFIG_PROSPECTOR_AMBIENT_MODE_TIMEOUT));
+}
+
+static int ambient_mode_layer_listener(const zmk_event_t *eh) {
+    if (ambient_screen == NULL) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    k_work_submit_to_queue(zmk_display_work_q(), &ambient_mode_exit_work);
+    ambient_mode_restart_timeout();
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(ambient_mode, ambient_mode_layer_listener);
+ZMK_SUBSCRIPTION(ambient_mode, zmk_layer_state_changed);
+
+void zmk_display_ambient_mode_init(lv_obj_t *screen) {
+    ambient_screen = screen;
+    ambient_mode_restart_timeout();
+}
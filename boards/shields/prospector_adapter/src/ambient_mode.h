@@ -0,0 +1,5 @@
+#pragma once
+
+#include <lvgl.h>
+
+void zmk_display_ambient_mode_init(lv_obj_t *screen);
@@ -0,0 +1,571 @@
+#include <stdlib.h>
+#include <string.h>
+#include <lvgl.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/crc.h>
+#include <drivers/display/st7789v.h>
+#if IS_ENABLED(CONFIG_LV_Z_COALESCE_AREAS)
+#include <lvgl_coalesce.h>
+#endif
+
+#include <zmk/display.h>
+#include <zmk/keymap.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/battery_state_changed.h>
+#include <zmk/events/split_central_status_changed.h>
+#if IS_ENABLED(CONFIG_DT_HAS_ZMK_BEHAVIOR_CAPS_WORD_ENABLED)
+#include <zmk/events/caps_word_state_changed.h>
+#endif
+
+#include "widgets/battery_bar.h"
+#if !IS_ENABLED(CONFIG_PROSPECTOR_LAYER_CAROUSEL)
+#include "widgets/layer_roller.h"
+#endif
+
+// Long enough for the roller and battery animations to finish
+#define BENCH_SETTLE_MS 500
+
+static const struct device *display = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+
+static void bench_layer(int index) { zmk_keymap_layer_to(zmk_keymap_layer_index_to_id(index)); }
+
+static void bench_battery(int level) {
+    raise_zmk_peripheral_battery_state_changed(
+        (struct zmk_peripheral_battery_state_changed){.source = 0, .state_of_charge = level});
+}
+
+static void bench_connection(int connected) {
+    raise_zmk_split_central_status_changed(
+        (struct zmk_split_central_status_changed){.slot = 0, .connected = connected});
+}
+
+#if IS_ENABLED(CONFIG_DT_HAS_ZMK_BEHAVIOR_CAPS_WORD_ENABLED)
+static void bench_caps_word(int active) {
+    raise_zmk_caps_word_state_changed((struct zmk_caps_word_state_changed){.active = active});
+}
+#endif
+
+struct bench_step {
+    const char *name;
+    void (*run)(int arg);
+    int arg;
+};
+
+static const struct bench_step bench_steps[] = {
+    {"battery 100", bench_battery, 100},
+    {"battery 20", bench_battery, 20},
+    {"battery 19", bench_battery, 19},
+    {"battery 0", bench_battery, 0},
+    {"disconnect", bench_connection, false},
+    {"connect", bench_connection, true},
+#if IS_ENABLED(CONFIG_DT_HAS_ZMK_BEHAVIOR_CAPS_WORD_ENABLED)
+    {"caps word on", bench_caps_word, true},
+    {"caps word off", bench_caps_word, false},
+#endif
+};
+
+typedef void (*bench_step_fn)(const struct shell *sh, const char *name, void (*run)(int), int arg,
+                              struct st7789v_stats *total);
+
+// Walks every layer, then the fixed steps, calling step_fn for each state
+static void bench_run_steps(const struct shell *sh, bench_step_fn step_fn,
+                            struct st7789v_stats *total) {
+    char name[16];
+
+    for (int i = 1; i < ZMK_KEYMAP_LAYERS_LEN; i++) {
+        snprintf(name, sizeof(name), "layer %d", i);
+        step_fn(sh, name, bench_layer, i, total);
+    }
+    step_fn(sh, "layer 0", bench_layer, 0, total);
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_steps); i++) {
+        step_fn(sh, bench_steps[i].name, bench_steps[i].run, bench_steps[i].arg, total);
+    }
+}
+
+// Set by "prospector bench csv" for output meant for scripts
+static bool bench_csv;
+
+static void bench_print_header(const struct shell *sh) {
+    if (bench_csv) {
+        shell_print(sh, "step,writes,pixels,bytes,txns,bus_us,avg_us,max_us,styles");
+        return;
+    }
+
+    shell_print(sh, "%-16s %6s %8s %8s %6s %8s %8s %8s %6s", "step", "writes", "pixels", "bytes",
+                "txns", "bus us", "avg us", "max us", "styles");
+}
+
+static void bench_print_row(const struct shell *sh, const char *name,
+                            const struct st7789v_stats *stats, uint32_t styles) {
+    uint32_t avg_us =
+        stats->writes ? (uint32_t)(k_cyc_to_us_floor64(stats->write_cycles) / stats->writes) : 0;
+
+    shell_print(sh, bench_csv ? "%s,%u,%llu,%llu,%u,%llu,%u,%u,%u"
+                              : "%-16s %6u %8llu %8llu %6u %8llu %8u %8u %6u",
+                name, stats->writes, stats->pixels, stats->bytes, stats->transactions,
+                k_cyc_to_us_floor64(stats->spi_cycles), avg_us,
+                k_cyc_to_us_floor32(stats->max_write_cycles), styles);
+}
+
+// Summary values, one "name,value" row each in CSV output
+static void bench_print_metric(const struct shell *sh, const char *name, uint64_t value) {
+    shell_print(sh, bench_csv ? "%s,%llu" : "  %-20s %llu", name, value);
+}
+
+// Style refreshes of the battery bar objects, the widget updated most often
+static uint32_t bench_style_refreshes(void) {
+    return zmk_widget_battery_bar_style_refreshes();
+}
+
+static void bench_measure(const struct shell *sh, const char *name, void (*run)(int), int arg,
+                          struct st7789v_stats *total) {
+    struct st7789v_stats stats;
+    uint32_t styles = bench_style_refreshes();
+
+    st7789v_reset_stats(display);
+    run(arg);
+    k_msleep(BENCH_SETTLE_MS);
+    st7789v_get_stats(display, &stats);
+    styles = bench_style_refreshes() - styles;
+
+    bench_print_row(sh, name, &stats, styles);
+
+    total->writes += stats.writes;
+    total->pixels += stats.pixels;
+    total->bytes += stats.bytes;
+    total->transactions += stats.transactions;
+    total->spi_cycles += stats.spi_cycles;
+    total->write_cycles += stats.write_cycles;
+    total->max_write_cycles = MAX(total->max_write_cycles, stats.max_write_cycles);
+    for (int i = 0; i < ST7789V_STATS_AREA_BUCKETS; i++) {
+        total->area_hist[i] += stats.area_hist[i];
+    }
+}
+
+static int cmd_bench(const struct shell *sh, size_t argc, char **argv) {
+    struct st7789v_stats total = {0};
+    char name[24];
+#if IS_ENABLED(CONFIG_LV_Z_COALESCE_AREAS)
+    struct lvgl_coalesce_stats coalesce_before, coalesce_after;
+
+    lvgl_coalesce_get_stats(&coalesce_before);
+#endif
+
+    bench_csv = argc > 1 && strcmp(argv[1], "csv") == 0;
+    if (argc > 1 && !bench_csv) {
+        shell_error(sh, "unknown argument: %s", argv[1]);
+        return -EINVAL;
+    }
+
+    uint32_t styles = bench_style_refreshes();
+    uint32_t applied_before, suppressed_before, applied, suppressed;
+
+    zmk_widget_battery_bar_update_counts(&applied_before, &suppressed_before);
+
+    bench_print_header(sh);
+    bench_run_steps(sh, bench_measure, &total);
+    bench_print_row(sh, "total", &total, bench_style_refreshes() - styles);
+
+    // Summary section, separated from the step table by an empty line
+    shell_print(sh, bench_csv ? "\nmetric,value" : "\nsummary:");
+
+    for (int i = 0, shift = 6; i < ST7789V_STATS_AREA_BUCKETS; i++, shift += 2) {
+        if (i < ST7789V_STATS_AREA_BUCKETS - 1) {
+            snprintf(name, sizeof(name), "areas_lt_%u", (uint32_t)BIT(shift));
+        } else {
+            snprintf(name, sizeof(name), "areas_ge_%u", (uint32_t)BIT(shift - 2));
+        }
+        bench_print_metric(sh, name, total.area_hist[i]);
+    }
+
+    zmk_widget_battery_bar_update_counts(&applied, &suppressed);
+    bench_print_metric(sh, "battery_applied", applied - applied_before);
+    bench_print_metric(sh, "battery_suppressed", suppressed - suppressed_before);
+
+#if IS_ENABLED(CONFIG_LV_Z_COALESCE_AREAS)
+    lvgl_coalesce_get_stats(&coalesce_after);
+    bench_print_metric(sh, "coalesce_frames", coalesce_after.frames - coalesce_before.frames);
+    bench_print_metric(sh, "coalesce_areas_in", coalesce_after.areas_in - coalesce_before.areas_in);
+    bench_print_metric(sh, "coalesce_areas_out",
+                       coalesce_after.areas_out - coalesce_before.areas_out);
+    bench_print_metric(sh, "coalesce_extra_px",
+                       coalesce_after.extra_pixels - coalesce_before.extra_pixels);
+#endif
+
+    return 0;
+}
+
+// Strip heights tried by "prospector vdb", as in CONFIG_LV_Z_VDB_SIZE
+static const uint8_t vdb_candidates[] = {5, 10, 15, 25, 35, 50, 75, 100};
+
+#define VDB_REPEAT 3
+
+static K_SEM_DEFINE(vdb_done, 0, 1);
+static uint32_t vdb_pixels;
+static uint32_t vdb_frame_cycles;
+
+static void vdb_wait_flushed(lv_disp_draw_buf_t *draw_buf) {
+    while (draw_buf->flushing) {
+        k_yield();
+    }
+}
+
+// Redraws the whole screen with the draw buffer limited to vdb_pixels, so
+// LVGL renders and flushes in strips of that size
+static void vdb_refresh_work_cb(struct k_work *work) {
+    lv_disp_draw_buf_t *draw_buf = lv_disp_get_default()->driver->draw_buf;
+    uint32_t size = draw_buf->size;
+    uint32_t start;
+
+    vdb_wait_flushed(draw_buf);
+    draw_buf->size = MIN(vdb_pixels, size);
+
+    start = k_cycle_get_32();
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    vdb_wait_flushed(draw_buf);
+    vdb_frame_cycles = k_cycle_get_32() - start;
+
+    draw_buf->size = size;
+    k_sem_give(&vdb_done);
+}
+
+static K_WORK_DEFINE(vdb_refresh_work, vdb_refresh_work_cb);
+
+static int cmd_vdb(const struct shell *sh, size_t argc, char **argv) {
+    lv_disp_t *disp = lv_disp_get_default();
+    uint32_t screen = lv_disp_get_hor_res(disp) * lv_disp_get_ver_res(disp);
+    uint32_t available = disp->driver->draw_buf->size;
+    uint32_t buffers = disp->driver->draw_buf->buf2 ? 2 : 1;
+    uint32_t frame_us[ARRAY_SIZE(vdb_candidates)] = {0};
+    uint32_t best_us = UINT32_MAX;
+    int tolerance = argc > 1 ? atoi(argv[1]) : 10;
+    int pick = -1;
+
+    shell_print(sh, "%-6s %6s %8s %8s %8s %8s", "vdb %", "rows", "bytes", "frame us", "flush us",
+                "render us");
+
+    for (int i = 0; i < ARRAY_SIZE(vdb_candidates); i++) {
+        struct st7789v_stats stats;
+        uint64_t frame_cycles = 0;
+
+        vdb_pixels = screen * vdb_candidates[i] / 100;
+        if (vdb_pixels > available) {
+            shell_print(sh, "%5u%% exceeds the allocated draw buffer", vdb_candidates[i]);
+            break;
+        }
+
+        st7789v_reset_stats(display);
+        for (int n = 0; n < VDB_REPEAT; n++) {
+            k_work_submit_to_queue(zmk_display_work_q(), &vdb_refresh_work);
+            k_sem_take(&vdb_done, K_FOREVER);
+            frame_cycles += vdb_frame_cycles;
+        }
+        st7789v_get_stats(display, &stats);
+
+        frame_us[i] = k_cyc_to_us_floor64(frame_cycles / VDB_REPEAT);
+        best_us = MIN(best_us, frame_us[i]);
+
+        uint32_t flush_us = k_cyc_to_us_floor64(stats.write_cycles / VDB_REPEAT);
+        shell_print(sh, "%5u%% %6u %8u %8u %8u %8u", vdb_candidates[i],
+                    vdb_pixels / lv_disp_get_hor_res(disp),
+                    buffers * vdb_pixels * (uint32_t)sizeof(lv_color_t), frame_us[i], flush_us,
+                    frame_us[i] > flush_us ? frame_us[i] - flush_us : 0);
+    }
+
+    // Smallest buffer within tolerance of the fastest frame
+    for (int i = 0; i < ARRAY_SIZE(vdb_candidates) && frame_us[i] > 0; i++) {
+        if ((uint64_t)frame_us[i] * 100 <= (uint64_t)best_us * (100 + tolerance)) {
+            pick = i;
+            break;
+        }
+    }
+
+    if (pick >= 0) {
+        shell_print(sh, "suggested: CONFIG_LV_Z_VDB_SIZE=%u (within %d%% of the fastest frame)",
+                    vdb_candidates[pick], tolerance);
+    }
+
+    return 0;
+}
+
+#define FPS_DURATION_MS 2000
+// Shorter than the 100 ms roller animation, so each layer change starts
+// before the previous scroll has settled and every measured frame animates
+#define FPS_LAYER_INTERVAL_MS 80
+
+static uint32_t fps_frames;
+static uint32_t fps_render_ms;
+
+static void fps_monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px) {
+    fps_frames++;
+    fps_render_ms += time;
+}
+
+static int cmd_fps(const struct shell *sh, size_t argc, char **argv) {
+    lv_disp_drv_t *disp_drv = lv_disp_get_default()->driver;
+    int layers = MAX(ZMK_KEYMAP_LAYERS_LEN, 2);
+    int64_t start, elapsed;
+
+    fps_frames = 0;
+    fps_render_ms = 0;
+    disp_drv->monitor_cb = fps_monitor_cb;
+
+    start = k_uptime_get();
+    for (int i = 1; k_uptime_get() - start < FPS_DURATION_MS; i++) {
+        bench_layer(i % layers);
+        k_msleep(FPS_LAYER_INTERVAL_MS);
+    }
+    elapsed = k_uptime_get() - start;
+
+    disp_drv->monitor_cb = NULL;
+    bench_layer(0);
+
+    shell_print(sh, "%u frames in %lld ms: %u.%u fps, %u ms per refresh", fps_frames, elapsed,
+                (uint32_t)(fps_frames * 1000 / elapsed),
+                (uint32_t)(fps_frames * 10000 / elapsed % 10),
+                fps_frames ? fps_render_ms / fps_frames : 0);
+
+    return 0;
+}
+
+struct rotation_case {
+    enum display_orientation orientation;
+    lv_disp_rot_t rotation;
+};
+
+// Both directions are switched through at least once, whatever the boot rotation
+static const struct rotation_case rotation_cases[] = {
+    {DISPLAY_ORIENTATION_ROTATED_90, LV_DISP_ROT_90},
+    {DISPLAY_ORIENTATION_ROTATED_270, LV_DISP_ROT_270},
+    {DISPLAY_ORIENTATION_ROTATED_90, LV_DISP_ROT_90},
+};
+
+static K_SEM_DEFINE(rotation_done, 0, 1);
+static const struct rotation_case *rotation_target;
+static int rotation_err;
+
+// Rotates the panel and lets LVGL follow, from the display thread
+static void rotation_work_cb(struct k_work *work) {
+    rotation_err = display_set_orientation(display, rotation_target->orientation);
+    if (rotation_err == 0) {
+        lv_disp_set_rotation(NULL, rotation_target->rotation);
+    }
+    k_sem_give(&rotation_done);
+}
+
+static K_WORK_DEFINE(rotation_work, rotation_work_cb);
+
+static int rotation_set(const struct rotation_case *target) {
+    rotation_target = target;
+    k_work_submit_to_queue(zmk_display_work_q(), &rotation_work);
+    k_sem_take(&rotation_done, K_FOREVER);
+
+    return rotation_err;
+}
+
+static K_SEM_DEFINE(redraw_done, 0, 1);
+static uint32_t redraw_cycles;
+
+// Redraws the whole screen, only from the display thread where LVGL may be used
+static void redraw_now(void) {
+    uint32_t start = k_cycle_get_32();
+
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+
+    redraw_cycles = k_cycle_get_32() - start;
+}
+
+// Test frame drawn over everything on the top layer: one background colour
+// with a marker in the top left corner, so its pixels are known up front
+#define ROTATION_MARKER_W 32
+#define ROTATION_MARKER_H 16
+#define ROTATION_BG lv_color_hex(0x0000ff)
+#define ROTATION_MARKER lv_color_hex(0xff0000)
+
+#define DISPLAY_WIDTH DT_PROP(DT_CHOSEN(zephyr_display), width)
+#define DISPLAY_HEIGHT DT_PROP(DT_CHOSEN(zephyr_display), height)
+#define DISPLAY_X_OFFSET DT_PROP(DT_CHOSEN(zephyr_display), x_offset)
+#define DISPLAY_Y_OFFSET DT_PROP(DT_CHOSEN(zephyr_display), y_offset)
+
+static uint32_t rotation_crc;
+
+// Draws the test frame from the display thread and hashes the pixels sent
+static void rotation_frame_work_cb(struct k_work *work) {
+    lv_obj_t *frame = lv_obj_create(lv_layer_top());
+    lv_obj_t *marker = lv_obj_create(frame);
+
+    lv_obj_remove_style_all(frame);
+    lv_obj_set_size(frame, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_style_bg_color(frame, ROTATION_BG, 0);
+    lv_obj_set_style_bg_opa(frame, LV_OPA_COVER, 0);
+
+    lv_obj_remove_style_all(marker);
+    lv_obj_set_size(marker, ROTATION_MARKER_W, ROTATION_MARKER_H);
+    lv_obj_set_style_bg_color(marker, ROTATION_MARKER, 0);
+    lv_obj_set_style_bg_opa(marker, LV_OPA_COVER, 0);
+
+    lv_obj_update_layout(frame);
+    st7789v_crc_start(display);
+    redraw_now();
+    st7789v_crc_stop(display, &rotation_crc);
+
+    lv_obj_del(frame);
+    k_sem_give(&redraw_done);
+}
+
+static K_WORK_DEFINE(rotation_frame_work, rotation_frame_work_cb);
+
+// CRC the driver must see for the test frame at the current resolution,
+// rows in order as a full redraw sends them
+static uint32_t rotation_expected_crc(lv_disp_t *disp) {
+    lv_coord_t hor = lv_disp_get_hor_res(disp);
+    lv_coord_t ver = lv_disp_get_ver_res(disp);
+    lv_color_t row[MAX(DISPLAY_WIDTH, DISPLAY_HEIGHT)];
+    uint32_t crc = 0;
+
+    for (lv_coord_t y = 0; y < ver; y++) {
+        for (lv_coord_t x = 0; x < hor; x++) {
+            bool in_marker = x < ROTATION_MARKER_W && y < ROTATION_MARKER_H;
+
+            row[x] = in_marker ? ROTATION_MARKER : ROTATION_BG;
+        }
+        crc = crc32_ieee_update(crc, (const uint8_t *)row, hor * sizeof(lv_color_t));
+    }
+
+    return crc;
+}
+
+// With MV set the panel's rows are addressed as columns, so the devicetree
+// offsets swap. A full redraw ends with a strip reaching the bottom right.
+static bool rotation_window_ok(const struct shell *sh, lv_disp_t *disp) {
+    uint16_t col_start = DISPLAY_Y_OFFSET;
+    uint16_t col_end = col_start + lv_disp_get_hor_res(disp) - 1;
+    uint16_t row_min = DISPLAY_X_OFFSET;
+    uint16_t row_end = row_min + lv_disp_get_ver_res(disp) - 1;
+    uint16_t window[4];
+    int err;
+
+    err = st7789v_get_window(display, window);
+    if (err) {
+        shell_error(sh, "no window sent: %d", err);
+        return false;
+    }
+
+    shell_print(sh, "  CASET %u-%u (expected %u-%u), RASET %u-%u (expected %u..%u)", window[0],
+                window[1], col_start, col_end, window[2], window[3], row_min, row_end);
+
+    return window[0] == col_start && window[1] == col_end && window[2] >= row_min &&
+           window[3] == row_end;
+}
+
+// Each rotation must send the test frame unrotated by LVGL and keep the panel
+// offsets, also when switching 90 <-> 270
+static int cmd_rotation(const struct shell *sh, size_t argc, char **argv) {
+    lv_disp_t *disp = lv_disp_get_default();
+    struct display_capabilities caps;
+    struct rotation_case initial;
+    bool pass = !disp->driver->sw_rotate;
+    int err = 0;
+
+    display_get_capabilities(display, &caps);
+    initial.orientation = caps.current_orientation;
+    initial.rotation = lv_disp_get_rotation(disp);
+
+    shell_print(sh, "rotation by the %s", disp->driver->sw_rotate ? "LVGL" : "display controller");
+
+    for (int i = 0; i < ARRAY_SIZE(rotation_cases); i++) {
+        err = rotation_set(&rotation_cases[i]);
+        if (err) {
+            shell_error(sh, "failed to rotate: %d", err);
+            break;
+        }
+
+        k_work_submit_to_queue(zmk_display_work_q(), &rotation_frame_work);
+        k_sem_take(&redraw_done, K_FOREVER);
+
+        uint32_t expected = rotation_expected_crc(disp);
+
+        shell_print(sh, "%3d degrees: %dx%d, frame %u us, crc32 %08x (expected %08x)",
+                    rotation_cases[i].rotation * 90, lv_disp_get_hor_res(disp),
+                    lv_disp_get_ver_res(disp), k_cyc_to_us_floor32(redraw_cycles),
+                    rotation_crc, expected);
+        pass &= rotation_crc == expected;
+        pass &= rotation_window_ok(sh, disp);
+    }
+
+    rotation_set(&initial);
+
+    if (err) {
+        return err;
+    }
+
+    if (!pass) {
+        shell_error(sh, "FAIL");
+        return -EIO;
+    }
+
+    shell_print(sh, "PASS");
+    return 0;
+}
+
+#if !IS_ENABLED(CONFIG_PROSPECTOR_LAYER_CAROUSEL)
+// Roller render time of a transition to layer 1 and back
+static uint32_t fade_measure(bool masks) {
+    uint32_t cycles;
+
+    zmk_widget_layer_roller_use_fade_masks(masks);
+    cycles = zmk_widget_layer_roller_draw_cycles();
+
+    bench_layer(1);
+    k_msleep(BENCH_SETTLE_MS);
+    bench_layer(0);
+    k_msleep(BENCH_SETTLE_MS);
+
+    return k_cyc_to_us_floor32(zmk_widget_layer_roller_draw_cycles() - cycles);
+}
+
+static int cmd_fade(const struct shell *sh, size_t argc, char **argv) {
+    uint32_t masks_us = fade_measure(true);
+    uint32_t table_us = fade_measure(false);
+
+    shell_print(sh, "roller render time per transition: %u us with masks, %u us with the "
+                    "fade table", masks_us, table_us);
+
+    return 0;
+}
+#endif
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_prospector,
+                               SHELL_CMD_ARG(bench, NULL,
+                                             "Replay layer, battery, connection and caps word "
+                                             "updates and report display transfer costs, [csv] "
+                                             "for scripts",
+                                             cmd_bench, 1, 1),
+                               SHELL_CMD_ARG(vdb, NULL,
+                                             "Time full redraws with smaller draw buffer strips "
+                                             "and suggest the smallest one within [tolerance %] "
+                                             "of the fastest",
+                                             cmd_vdb, 1, 1),
+                               SHELL_CMD(fps, NULL,
+                                         "Keep the layer roller animating and report the "
+                                         "display refresh rate",
+                                         cmd_fps),
+                               SHELL_CMD(rotation, NULL,
+                                         "Switch between 90 and 270 degrees and check the "
+                                         "pixels and address window of a test frame",
+                                         cmd_rotation),
+#if !IS_ENABLED(CONFIG_PROSPECTOR_LAYER_CAROUSEL)
+                               SHELL_CMD(fade, NULL,
+                                         "Compare layer roller render time with gradient "
+                                         "masks and with the fade table",
+                                         cmd_fade),
+#endif
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(prospector, &sub_prospector, "Prospector display commands", NULL);
@@ -3,23 +3,38 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/display.h>
 
+#if IS_ENABLED(CONFIG_PROSPECTOR_LAYER_CAROUSEL)
+#include "widgets/layer_carousel.h"
+#else
 #include "widgets/layer_roller.h"
+#endif
 #include "widgets/battery_bar.h"
 #include "widgets/caps_word_indicator.h"
+#include "frame_rate.h"
+#include "ambient_mode.h"
 
 #include <fonts.h>
 #include <sf_symbols.h>
 
 #include <zmk/keymap.h>
+#include <lvgl_memory.h>
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#if IS_ENABLED(CONFIG_PROSPECTOR_LAYER_CAROUSEL)
+static struct zmk_widget_layer_carousel layer_carousel_widget;
+#else
 static struct zmk_widget_layer_roller layer_roller_widget;
+#endif
 static struct zmk_widget_battery_bar battery_bar_widget;
 static struct zmk_widget_caps_word_indicator caps_word_indicator_widget;
 
+static LVGL_MEM_ACCOUNT_DEFINE(status_screen);
+
 lv_obj_t *zmk_display_status_screen() {
+    LVGL_MEM_ACCOUNT_ENTER(status_screen);
+
     lv_obj_t *screen;
     screen = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), LV_PART_MAIN);
@@ -35,11 +50,25 @@ lv_obj_t *zmk_display_status_screen() {
     lv_obj_set_size(zmk_widget_battery_bar_obj(&battery_bar_widget), lv_pct(100), 48);
     lv_obj_align(zmk_widget_battery_bar_obj(&battery_bar_widget), LV_ALIGN_BOTTOM_MID, 0, 0);
 
+#if IS_ENABLED(CONFIG_PROSPECTOR_LAYER_CAROUSEL)
+    zmk_widget_layer_carousel_init(&layer_carousel_widget, screen);
+    lv_obj_set_size(zmk_widget_layer_carousel_obj(&layer_carousel_widget), 224, 140);
+    lv_obj_align(zmk_widget_layer_carousel_obj(&layer_carousel_widget), LV_ALIGN_LEFT_MID, 0, -20);
+#else
     zmk_widget_layer_roller_init(&layer_roller_widget, screen);
     lv_obj_set_size(zmk_widget_layer_roller_obj(&layer_roller_widget), 224, 140);
     lv_obj_align(zmk_widget_layer_roller_obj(&layer_roller_widget), LV_ALIGN_LEFT_MID, 0, -20);
+#endif
+
+#ifdef CONFIG_PROSPECTOR_DYNAMIC_FRAME_RATE
+    zmk_display_frame_rate_init();
+#endif
 
+#ifdef CONFIG_PROSPECTOR_AMBIENT_MODE
+    zmk_display_ambient_mode_init(screen);
+#endif
 
+    LVGL_MEM_ACCOUNT_EXIT();
     return screen;
 }
 
@@ -24,4 +24,8 @@ int disp_set_orientation(void)
 	return 0;
 }
 
+// LVGL picks the orientation up at init, so it must be set before
+BUILD_ASSERT(60 < CONFIG_APPLICATION_INIT_PRIORITY,
+	     "Display orientation must be set before LVGL is initialized");
+
 SYS_INIT(disp_set_orientation, APPLICATION, 60);
\ No newline at end of file
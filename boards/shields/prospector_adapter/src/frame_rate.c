@@ -0,0 +1,34 @@
+#include <lvgl.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <drivers/display/st7789v.h>
+
+#include "frame_rate.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define FRAME_RATE_CHECK_PERIOD_MS 100
+
+static const struct device *display = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+
+static bool animating = true;
+
+// Runs from lv_task_handler on the display thread, so LVGL state is safe to read
+static void frame_rate_check_cb(lv_timer_t *timer) {
+    bool running = lv_anim_count_running() > 0;
+
+    if (running == animating) {
+        return;
+    }
+
+    animating = running;
+    st7789v_set_frame_rate(display, animating ? CONFIG_PROSPECTOR_ACTIVE_FRAME_RATE
+                                              : CONFIG_PROSPECTOR_IDLE_FRAME_RATE);
+    LOG_DBG("Display frame rate set to %d Hz", animating ? CONFIG_PROSPECTOR_ACTIVE_FRAME_RATE
+                                                         : CONFIG_PROSPECTOR_IDLE_FRAME_RATE);
+}
+
+void zmk_display_frame_rate_init(void) {
+    lv_timer_create(frame_rate_check_cb, FRAME_RATE_CHECK_PERIOD_MS, NULL);
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void zmk_display_frame_rate_init(void);
@@ -0,0 +1,129 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/keymap.h>
+
+#include "layer_names.h"
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define KEYMAP_NODE DT_INST(0, zmk_keymap)
+
+// Layers can be renamed and reordered at runtime, keymap names win then
+#define LAYER_NAMES_RUNTIME                                                                        \
+    (IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING) || IS_ENABLED(CONFIG_ZMK_STUDIO))
+
+#define LAYER_NAME_OR(node, fallback)                                                              \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, display_name), (DT_PROP(node, display_name)),               \
+                (COND_CODE_1(DT_NODE_HAS_PROP(node, label), (DT_PROP(node, label)), (fallback))))
+
+#define LAYER_NAME(node) LAYER_NAME_OR(node, NULL)
+#define LAYER_LITERAL(node) LAYER_NAME_OR(node, STRINGIFY(DT_NODE_CHILD_IDX(node)))
+
+// "name0" "\n" "name1" ..., joined into one literal by the compiler
+#define LAYER_OPTIONS DT_FOREACH_CHILD_STATUS_OKAY_SEP(KEYMAP_NODE, LAYER_LITERAL, ("\n"))
+
+// The literal numbers unnamed layers by their devicetree child index, which
+// only matches the enabled index when no layer before them is disabled
+#define LAYER_UNNAMED(node)                                                                        \
+    !(DT_NODE_HAS_PROP(node, display_name) || DT_NODE_HAS_PROP(node, label)) ||
+#define LAYER_DISABLED(node) !DT_NODE_HAS_STATUS(node, okay) ||
+#define LAYER_OPTIONS_LITERAL                                                                      \
+    (!(DT_FOREACH_CHILD_STATUS_OKAY(KEYMAP_NODE, LAYER_UNNAMED) 0) ||                              \
+     !(DT_FOREACH_CHILD(KEYMAP_NODE, LAYER_DISABLED) 0))
+
+// Devicetree names of the enabled layers, NULL for unnamed ones
+static const char *const layer_names[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY_SEP(KEYMAP_NODE, LAYER_NAME, (, ))};
+
+BUILD_ASSERT(ARRAY_SIZE(layer_names) == ZMK_KEYMAP_LAYERS_LEN,
+             "Layer name table does not match the keymap");
+
+// Unnamed layers are shown by their index among the enabled layers
+static char layer_numbers[ZMK_KEYMAP_LAYERS_LEN][4];
+
+#if LAYER_NAMES_RUNTIME
+#ifdef CONFIG_ZMK_KEYMAP_LAYER_NAME_MAX_LEN
+#define LAYER_RUNTIME_NAME_MAX_LEN CONFIG_ZMK_KEYMAP_LAYER_NAME_MAX_LEN
+#else
+#define LAYER_RUNTIME_NAME_MAX_LEN 20
+#endif
+
+// Every name is either a runtime one or as long as in the literal at most
+#define LAYER_OPTIONS_SIZE                                                                         \
+    (sizeof(LAYER_OPTIONS) + ZMK_KEYMAP_LAYERS_LEN * (LAYER_RUNTIME_NAME_MAX_LEN + 1))
+#else
+// Enabled indexes are never longer than the child indexes in the literal
+#define LAYER_OPTIONS_SIZE sizeof(LAYER_OPTIONS)
+#endif
+
+const char *zmk_display_layer_name(int index) {
+    if (index < 0 || index >= ARRAY_SIZE(layer_names)) {
+        return "";
+    }
+
+#if LAYER_NAMES_RUNTIME
+    const char *name = zmk_keymap_layer_name(zmk_keymap_layer_index_to_id(index));
+
+    if (name != NULL && *name != '\0') {
+        return name;
+    }
+#endif
+
+    if (layer_names[index] != NULL) {
+        return layer_names[index];
+    }
+
+    if (layer_numbers[index][0] == '\0') {
+        snprintf(layer_numbers[index], sizeof(layer_numbers[index]), "%d", index);
+    }
+
+    return layer_numbers[index];
+}
+
+#if !LAYER_NAMES_RUNTIME && LAYER_OPTIONS_LITERAL &&                                              \
+    !IS_ENABLED(CONFIG_PROSPECTOR_LAYER_ROLLER_ALL_CAPS)
+static const char layer_options[] = LAYER_OPTIONS;
+
+const char *zmk_display_layer_names_options(void) { return layer_options; }
+#else
+static char layer_options[LAYER_OPTIONS_SIZE];
+
+const char *zmk_display_layer_names_options(void) {
+    static const char fallback[] = LAYER_OPTIONS;
+    size_t len = 0;
+
+    for (int i = 0; i < ZMK_KEYMAP_LAYERS_LEN; i++) {
+        const char *name = zmk_display_layer_name(i);
+        size_t name_len = strlen(name);
+
+        // The separator and terminator need room too
+        if (len + name_len + 2 > sizeof(layer_options)) {
+            LOG_ERR("Layer names do not fit in %zu bytes", sizeof(layer_options));
+            __ASSERT(false, "Layer names overflow the roller options");
+            return fallback;
+        }
+
+        if (i > 0) {
+            layer_options[len++] = '\n';
+        }
+
+        for (size_t j = 0; j < name_len; j++) {
+#if IS_ENABLED(CONFIG_PROSPECTOR_LAYER_ROLLER_ALL_CAPS)
+            layer_options[len++] = toupper((unsigned char)name[j]);
+#else
+            layer_options[len++] = name[j];
+#endif
+        }
+    }
+
+    layer_options[len] = '\0';
+
+    return layer_options;
+}
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+// Layer names as the keymap currently has them. With layer reordering or
+// ZMK Studio enabled the runtime names are used, otherwise and for layers
+// without one the devicetree display-name or label. Layers without any name
+// are shown by their index.
+
+// Names separated by '\n' as lv_roller options, with ALL_CAPS applied
+const char *zmk_display_layer_names_options(void);
+
+// Name of the layer at index, as in the keymap
+const char *zmk_display_layer_name(int index);
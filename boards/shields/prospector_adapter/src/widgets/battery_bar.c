@@ -1,5 +1,8 @@
 #include "battery_bar.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <lvgl_memory.h>
 #include <zmk/display.h>
 #include <zmk/battery.h>
 #include <zmk/ble.h>
@@ -12,6 +15,8 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+static LVGL_MEM_ACCOUNT_DEFINE(battery_bar);
+
 static sys_slist_t widgets = SYS_SLIST_STATIC_INIT(&widgets);
 
 bool initialized = false;
@@ -27,36 +32,154 @@ struct connection_update_state {
     bool connected;
 };
 
-static void set_battery_bar_value(lv_obj_t *widget, struct battery_update_state state) {
-    if (initialized) {
-        lv_obj_t *info_container = lv_obj_get_child(widget, state.source);
-        lv_obj_t *bar = lv_obj_get_child(info_container, 0);
-        lv_obj_t *num = lv_obj_get_child(info_container, 1);
+// Shared styles for the colours that change with the level, swapped as a
+// whole when a peripheral crosses the low battery threshold
+struct battery_bar_styles {
+    lv_style_t bar;
+    lv_style_t indicator;
+    lv_style_t num;
+};
 
-        lv_bar_set_value(bar, state.level, LV_ANIM_ON);
-        lv_label_set_text_fmt(num, "%d", state.level);
+static struct battery_bar_styles normal_styles;
+static struct battery_bar_styles low_styles;
+static lv_style_t disconnected_bar_style;
+static lv_style_t disconnected_num_style;
 
-        if (state.level < 20) {
-            lv_obj_set_style_bg_color(bar, lv_color_hex(0xD3900F), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_grad_color(bar, lv_color_hex(0xE8AC11), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_color(bar, lv_color_hex(0x6E4E07), LV_PART_MAIN);
-            lv_obj_set_style_text_color(num, lv_color_hex(0xFFB802), 0);
-        } else {
-            lv_obj_set_style_bg_color(bar, lv_color_hex(0x909090), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_grad_color(bar, lv_color_hex(0xf0f0f0), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_color(bar, lv_color_hex(0x202020), LV_PART_MAIN);
-            lv_obj_set_style_text_color(num, lv_color_hex(0xFFFFFF), 0);
-        }
+#if IS_ENABLED(CONFIG_PROSPECTOR_BENCHMARK)
+static uint32_t style_refreshes;
+
+uint32_t zmk_widget_battery_bar_style_refreshes(void) { return style_refreshes; }
+
+static void battery_bar_style_changed_cb(lv_event_t *e) { style_refreshes++; }
+#endif
+
+static void battery_bar_styles_init(struct battery_bar_styles *styles, uint32_t bar,
+                                    uint32_t indicator, uint32_t indicator_grad, uint32_t num) {
+    lv_style_init(&styles->bar);
+    lv_style_set_bg_color(&styles->bar, lv_color_hex(bar));
+
+    lv_style_init(&styles->indicator);
+    lv_style_set_bg_color(&styles->indicator, lv_color_hex(indicator));
+    lv_style_set_bg_grad_color(&styles->indicator, lv_color_hex(indicator_grad));
+
+    lv_style_init(&styles->num);
+    lv_style_set_text_color(&styles->num, lv_color_hex(num));
+}
+
+static void init_styles(void) {
+    static bool styles_initialized = false;
+
+    if (styles_initialized) {
+        return;
+    }
+
+    battery_bar_styles_init(&normal_styles, 0x202020, 0x909090, 0xf0f0f0, 0xFFFFFF);
+    battery_bar_styles_init(&low_styles, 0x6E4E07, 0xD3900F, 0xE8AC11, 0xFFB802);
+
+    lv_style_init(&disconnected_bar_style);
+    lv_style_set_bg_color(&disconnected_bar_style, lv_color_hex(0x9e2121));
+    lv_style_set_bg_opa(&disconnected_bar_style, 255);
+    lv_style_set_radius(&disconnected_bar_style, 1);
+
+    lv_style_init(&disconnected_num_style);
+    lv_style_set_text_color(&disconnected_num_style, lv_color_hex(0xe63030));
+
+    styles_initialized = true;
+}
+
+static void set_battery_bar_styles(lv_obj_t *bar, lv_obj_t *num, struct battery_bar_styles *from,
+                                   struct battery_bar_styles *to) {
+    lv_obj_replace_style(bar, &from->bar, &to->bar, LV_PART_MAIN);
+    lv_obj_replace_style(bar, &from->indicator, &to->indicator, LV_PART_INDICATOR);
+    lv_obj_replace_style(num, &from->num, &to->num, 0);
+}
+
+// Battery levels as text, so updates need neither printf nor a text allocation
+static const char level_text[101][BATTERY_BAR_NUM_TEXT_LEN] = {
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+    "10", "11", "12", "13", "14", "15", "16", "17", "18", "19",
+    "20", "21", "22", "23", "24", "25", "26", "27", "28", "29",
+    "30", "31", "32", "33", "34", "35", "36", "37", "38", "39",
+    "40", "41", "42", "43", "44", "45", "46", "47", "48", "49",
+    "50", "51", "52", "53", "54", "55", "56", "57", "58", "59",
+    "60", "61", "62", "63", "64", "65", "66", "67", "68", "69",
+    "70", "71", "72", "73", "74", "75", "76", "77", "78", "79",
+    "80", "81", "82", "83", "84", "85", "86", "87", "88", "89",
+    "90", "91", "92", "93", "94", "95", "96", "97", "98", "99",
+    "100",
+};
+
+// Shows a level through the slot's static text buffer. When only digits of
+// the same width change, the label keeps its size and is just redrawn,
+// without relaying it out. The whole label is invalidated, as glyphs can
+// draw outside their advance width and it is only three characters.
+static void set_battery_bar_num(struct zmk_widget_battery_bar_slot *slot, uint8_t level) {
+    const char *text = level_text[MIN(level, 100)];
+    const lv_font_t *font = lv_obj_get_style_text_font(slot->num, 0);
+    size_t len = strlen(text);
+    bool relayout = len != strlen(slot->num_text);
+
+    for (size_t i = 0; i < len && !relayout; i++) {
+        relayout = text[i] != slot->num_text[i] &&
+                   lv_font_get_glyph_width(font, text[i], 0) !=
+                       lv_font_get_glyph_width(font, slot->num_text[i], 0);
+    }
+
+    if (strcmp(text, slot->num_text) == 0) {
+        return;
+    }
+
+    strcpy(slot->num_text, text);
+
+    if (relayout) {
+        lv_label_set_text_static(slot->num, slot->num_text);
+    } else {
+        lv_obj_invalidate(slot->num);
+    }
+}
+
+static struct zmk_widget_battery_bar_slot *get_slot(struct zmk_widget_battery_bar *widget,
+                                                    uint8_t source) {
+    if (source >= ARRAY_SIZE(widget->slots)) {
+        LOG_WRN("Ignoring update for unknown peripheral %d", source);
+        return NULL;
+    }
+
+    return &widget->slots[source];
+}
+
+// Returns whether the level is now shown
+static bool set_battery_bar_value(struct zmk_widget_battery_bar *widget,
+                                  struct battery_update_state state) {
+    struct zmk_widget_battery_bar_slot *slot = get_slot(widget, state.source);
+
+    if (!initialized || !slot) {
+        return false;
     }
+
+    bool low = state.level < 20;
+
+    lv_bar_set_value(slot->bar, state.level, LV_ANIM_ON);
+    set_battery_bar_num(slot, state.level);
+
+    if (low != slot->low) {
+        set_battery_bar_styles(slot->bar, slot->num, low ? &normal_styles : &low_styles,
+                               low ? &low_styles : &normal_styles);
+        slot->low = low;
+    }
+
+    return true;
 }
 
-static void set_battery_bar_connected(lv_obj_t *widget, struct connection_update_state state) {
-    if (initialized) {
-        lv_obj_t *info_container = lv_obj_get_child(widget, state.source);
-        lv_obj_t *bar = lv_obj_get_child(info_container, 0);
-        lv_obj_t *num = lv_obj_get_child(info_container, 1);
-        lv_obj_t *nc_bar = lv_obj_get_child(info_container, 2);
-        lv_obj_t *nc_num = lv_obj_get_child(info_container, 3);
+static void set_battery_bar_connected(struct zmk_widget_battery_bar *widget,
+                                      struct connection_update_state state) {
+    struct zmk_widget_battery_bar_slot *slot = get_slot(widget, state.source);
+
+    if (initialized && slot) {
+        lv_obj_t *bar = slot->bar;
+        lv_obj_t *num = slot->num;
+        lv_obj_t *nc_bar = slot->nc_bar;
+        lv_obj_t *nc_num = slot->nc_num;
 
         LOG_DBG("Peripheral %d %s", state.source,
                 state.connected ? "connected" : "disconnected");
@@ -75,16 +198,133 @@ static void set_battery_bar_connected(lv_obj_t *widget, struct connection_update
     }
 }
 
-// Battery event handling
-void battery_bar_battery_update_cb(struct battery_update_state state) {
+// Last level shown per source, to drop reports that would not change it
+struct battery_cache {
+    bool valid;
+    uint8_t level;
+    int64_t time;
+    // Newest report held back by the interval, shown once it has passed
+    bool pending;
+    uint8_t pending_level;
+};
+
+static struct battery_cache battery_cache[CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+static uint32_t updates_applied;
+static uint32_t updates_suppressed;
+
+static void battery_pending_work_cb(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(battery_pending_work, battery_pending_work_cb);
+
+void zmk_widget_battery_bar_update_counts(uint32_t *applied, uint32_t *suppressed) {
+    *applied = updates_applied;
+    *suppressed = updates_suppressed;
+}
+
+static bool battery_update_needed(struct battery_update_state state) {
+    if (state.source >= ARRAY_SIZE(battery_cache)) {
+        return true;
+    }
+
+    struct battery_cache *cache = &battery_cache[state.source];
+    int64_t now = k_uptime_get();
+
+    // A newer report replaces whatever was held back
+    cache->pending = false;
+
+    if (!cache->valid) {
+        return true;
+    }
+
+    if (state.level == cache->level) {
+        return false;
+    }
+
+    if ((state.level < 20) != (cache->level < 20)) {
+        return true;
+    }
+
+    if (abs(state.level - cache->level) < CONFIG_PROSPECTOR_BATTERY_MIN_DELTA) {
+        return false;
+    }
+
+    if (now - cache->time < CONFIG_PROSPECTOR_BATTERY_MIN_INTERVAL_MS) {
+        cache->pending = true;
+        cache->pending_level = state.level;
+        k_work_schedule_for_queue(zmk_display_work_q(), &battery_pending_work,
+                                  K_MSEC(cache->time + CONFIG_PROSPECTOR_BATTERY_MIN_INTERVAL_MS -
+                                         now));
+        return false;
+    }
+
+    return true;
+}
+
+static void battery_bar_apply(struct battery_update_state state) {
+    bool shown = false;
+
+    LVGL_MEM_ACCOUNT_ENTER(battery_bar);
+
     LOG_DBG("Battery update: source=%d, level=%d", state.source, state.level);
 
     struct zmk_widget_battery_bar *widget;
     SYS_SLIST_FOR_EACH_CONTAINER(&widgets, widget, node) {
-        set_battery_bar_value(widget->obj, state);
+        shown |= set_battery_bar_value(widget, state);
+    }
+
+    LVGL_MEM_ACCOUNT_EXIT();
+
+    // Only a level that made it to the screen counts as shown
+    if (shown && state.source < ARRAY_SIZE(battery_cache)) {
+        struct battery_cache *cache = &battery_cache[state.source];
+
+        cache->valid = true;
+        cache->level = state.level;
+        cache->time = k_uptime_get();
+        updates_applied++;
+    }
+}
+
+// Shows the levels held back by the interval, runs on the display work queue
+static void battery_pending_work_cb(struct k_work *work) {
+    int64_t now = k_uptime_get();
+    int64_t next = INT64_MAX;
+
+    for (uint8_t source = 0; source < ARRAY_SIZE(battery_cache); source++) {
+        struct battery_cache *cache = &battery_cache[source];
+        int64_t due = cache->time + CONFIG_PROSPECTOR_BATTERY_MIN_INTERVAL_MS;
+
+        if (!cache->pending) {
+            continue;
+        }
+
+        if (due > now) {
+            next = MIN(next, due);
+            continue;
+        }
+
+        cache->pending = false;
+        battery_bar_apply((struct battery_update_state){
+            .source = source,
+            .level = cache->pending_level,
+        });
+    }
+
+    if (next != INT64_MAX) {
+        k_work_schedule_for_queue(zmk_display_work_q(), &battery_pending_work,
+                                  K_MSEC(next - now));
     }
 }
 
+// Battery event handling
+void battery_bar_battery_update_cb(struct battery_update_state state) {
+    if (!battery_update_needed(state)) {
+        updates_suppressed++;
+        return;
+    }
+
+    battery_bar_apply(state);
+}
+
 static struct battery_update_state battery_bar_get_battery_state(const zmk_event_t *eh) {
     const struct zmk_peripheral_battery_state_changed *bat_ev =
         as_zmk_peripheral_battery_state_changed(eh);
@@ -99,12 +339,16 @@ static struct battery_update_state battery_bar_get_battery_state(const zmk_event
 
 // Connection event handling
 void battery_bar_connection_update_cb(struct connection_update_state state) {
+    LVGL_MEM_ACCOUNT_ENTER(battery_bar);
+
     LOG_DBG("Connection update: source=%d, connected=%s", state.source, state.connected ? "true" : "false");
 
     struct zmk_widget_battery_bar *widget;
     SYS_SLIST_FOR_EACH_CONTAINER(&widgets, widget, node) {
-        set_battery_bar_connected(widget->obj, state);
+        set_battery_bar_connected(widget, state);
     }
+
+    LVGL_MEM_ACCOUNT_EXIT();
 }
 
 static struct connection_update_state battery_bar_get_connection_state(const zmk_event_t *eh) {
@@ -129,6 +373,10 @@ ZMK_DISPLAY_WIDGET_LISTENER(widget_battery_bar_connection, struct connection_upd
 ZMK_SUBSCRIPTION(widget_battery_bar_connection, zmk_split_central_status_changed);
 
 int zmk_widget_battery_bar_init(struct zmk_widget_battery_bar *widget, lv_obj_t *parent) {
+    LVGL_MEM_ACCOUNT_ENTER(battery_bar);
+
+    init_styles();
+
     widget->obj = lv_obj_create(parent);
     lv_obj_set_width(widget->obj, lv_pct(100));
     lv_obj_set_flex_flow(widget->obj, LV_FLEX_FLOW_ROW);
@@ -145,7 +393,8 @@ int zmk_widget_battery_bar_init(struct zmk_widget_battery_bar *widget, lv_obj_t
 
     // lv_obj_add_flag(widget->obj, LV_OBJ_FLAG_OVERFLOW_VISIBLE);
 
-    for (int i = 0; i < CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+    for (int i = 0; i < ARRAY_SIZE(widget->slots); i++) {
+        struct zmk_widget_battery_bar_slot *slot = &widget->slots[i];
         lv_obj_t *info_container = lv_obj_create(widget->obj);
         lv_obj_center(info_container);
         lv_obj_set_height(info_container, lv_pct(100));
@@ -154,12 +403,11 @@ int zmk_widget_battery_bar_init(struct zmk_widget_battery_bar *widget, lv_obj_t
         lv_obj_t *bar = lv_bar_create(info_container);
         lv_obj_set_size(bar, lv_pct(100), 4);
         lv_obj_align(bar, LV_ALIGN_BOTTOM_MID, 0, 0);
-        lv_obj_set_style_bg_color(bar, lv_color_hex(0x202020), LV_PART_MAIN);
+        lv_obj_add_style(bar, &normal_styles.bar, LV_PART_MAIN);
         lv_obj_set_style_bg_opa(bar, 255, LV_PART_MAIN);
         lv_obj_set_style_radius(bar, 1, LV_PART_MAIN);
-        lv_obj_set_style_bg_color(bar, lv_color_hex(0x909090), LV_PART_INDICATOR);
+        lv_obj_add_style(bar, &normal_styles.indicator, LV_PART_INDICATOR);
         lv_obj_set_style_bg_opa(bar, 255, LV_PART_INDICATOR);
-        lv_obj_set_style_bg_grad_color(bar, lv_color_hex(0xf0f0f0), LV_PART_INDICATOR);
         lv_obj_set_style_bg_dither_mode(bar, LV_DITHER_ERR_DIFF, LV_PART_INDICATOR);
         lv_obj_set_style_bg_grad_dir(bar, LV_GRAD_DIR_HOR, LV_PART_INDICATOR);
         lv_obj_set_style_radius(bar, 1, LV_PART_INDICATOR);
@@ -171,25 +419,35 @@ int zmk_widget_battery_bar_init(struct zmk_widget_battery_bar *widget, lv_obj_t
 
         lv_obj_t *num = lv_label_create(info_container);
         lv_obj_set_style_text_font(num, &FoundryGridnikMedium_20, 0);
-        lv_obj_set_style_text_color(num, lv_color_white(), 0);
+        lv_obj_add_style(num, &normal_styles.num, 0);
         lv_obj_set_style_opa(num, 255, 0);
         lv_obj_align(num, LV_ALIGN_CENTER, 0, 0);
-        lv_label_set_text(num, "N/A");
+        strcpy(slot->num_text, "N/A");
+        lv_label_set_text_static(num, slot->num_text);
 
         lv_obj_set_style_opa(num, 0, 0);
 
         lv_obj_t *nc_bar = lv_obj_create(info_container);
         lv_obj_set_size(nc_bar, lv_pct(100), 4);
         lv_obj_align(nc_bar, LV_ALIGN_BOTTOM_MID, 0, 0);
-        lv_obj_set_style_bg_color(nc_bar, lv_color_hex(0x9e2121), LV_PART_MAIN);
-        lv_obj_set_style_radius(nc_bar, 1, LV_PART_MAIN);
-        lv_obj_set_style_bg_opa(nc_bar, 255, 0);
+        lv_obj_add_style(nc_bar, &disconnected_bar_style, LV_PART_MAIN);
 
         lv_obj_t *nc_num = lv_label_create(info_container);
-        lv_obj_set_style_text_color(nc_num, lv_color_hex(0xe63030), 0);
+        lv_obj_add_style(nc_num, &disconnected_num_style, 0);
         lv_obj_align(nc_num, LV_ALIGN_CENTER, 0, 0);
         lv_label_set_text(nc_num, LV_SYMBOL_CLOSE);
         lv_obj_set_style_opa(nc_num, 255, 0);
+
+        slot->bar = bar;
+        slot->num = num;
+        slot->nc_bar = nc_bar;
+        slot->nc_num = nc_num;
+        slot->low = false;
+
+#if IS_ENABLED(CONFIG_PROSPECTOR_BENCHMARK)
+        lv_obj_add_event_cb(bar, battery_bar_style_changed_cb, LV_EVENT_STYLE_CHANGED, NULL);
+        lv_obj_add_event_cb(num, battery_bar_style_changed_cb, LV_EVENT_STYLE_CHANGED, NULL);
+#endif
     }
 
     sys_slist_append(&widgets, &widget->node);
@@ -198,6 +456,7 @@ int zmk_widget_battery_bar_init(struct zmk_widget_battery_bar *widget, lv_obj_t
     widget_battery_bar_connection_init();
     initialized = true;
 
+    LVGL_MEM_ACCOUNT_EXIT();
     return 0;
 }
 
@@ -3,10 +3,33 @@
 #include <lvgl.h>
 #include <zephyr/kernel.h>
 
+// Room for "100" or "N/A"
+#define BATTERY_BAR_NUM_TEXT_LEN 4
+
+// Objects of one peripheral slot, so events resolve without walking the tree
+struct zmk_widget_battery_bar_slot {
+    lv_obj_t *bar;
+    lv_obj_t *num;
+    lv_obj_t *nc_bar;
+    lv_obj_t *nc_num;
+    // Text shown by num, set with lv_label_set_text_static()
+    char num_text[BATTERY_BAR_NUM_TEXT_LEN];
+    bool low;
+};
+
 struct zmk_widget_battery_bar {
     sys_snode_t node;
     lv_obj_t *obj;
+    struct zmk_widget_battery_bar_slot slots[CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
 };
 
 int zmk_widget_battery_bar_init(struct zmk_widget_battery_bar *widget, lv_obj_t *parent);
-lv_obj_t *zmk_widget_battery_bar_obj(struct zmk_widget_battery_bar *widget);
\ No newline at end of file
+lv_obj_t *zmk_widget_battery_bar_obj(struct zmk_widget_battery_bar *widget);
+
+// Battery reports shown and dropped as unchanged or too close to the last one
+void zmk_widget_battery_bar_update_counts(uint32_t *applied, uint32_t *suppressed);
+
+#if IS_ENABLED(CONFIG_PROSPECTOR_BENCHMARK)
+// Style refreshes of the bar and number objects since boot
+uint32_t zmk_widget_battery_bar_style_refreshes(void);
+#endif
@@ -1,5 +1,6 @@
 #include "caps_word_indicator.h"
 
+#include <lvgl_memory.h>
 #include <zmk/display.h>
 #include <zmk/events/caps_word_state_changed.h>
 #include <zmk/event_manager.h>
@@ -10,6 +11,8 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+static LVGL_MEM_ACCOUNT_DEFINE(caps_word_indicator);
+
 static sys_slist_t widgets = SYS_SLIST_STATIC_INIT(&widgets);
 
 struct caps_word_indicator_state {
@@ -25,10 +28,14 @@ static void caps_word_indicator_set_active(lv_obj_t *label, struct caps_word_ind
 }
 
 static void caps_word_indicator_update_cb(struct caps_word_indicator_state state) {
+    LVGL_MEM_ACCOUNT_ENTER(caps_word_indicator);
+
     struct zmk_widget_caps_word_indicator *widget;
     SYS_SLIST_FOR_EACH_CONTAINER(&widgets, widget, node) {
         caps_word_indicator_set_active(widget->obj, state);
     }
+
+    LVGL_MEM_ACCOUNT_EXIT();
 }
 
 static struct caps_word_indicator_state caps_word_indicator_get_state(const zmk_event_t *eh) {
@@ -46,6 +53,8 @@ ZMK_SUBSCRIPTION(widget_caps_word_indicator, zmk_caps_word_state_changed);
 
 int zmk_widget_caps_word_indicator_init(struct zmk_widget_caps_word_indicator *widget,
                                         lv_obj_t *parent) {
+    LVGL_MEM_ACCOUNT_ENTER(caps_word_indicator);
+
     widget->obj = lv_label_create(parent);
 
     // LV_FONT_DECLARE(SF_Compact_Text_Bold_32);
@@ -58,6 +67,8 @@ int zmk_widget_caps_word_indicator_init(struct zmk_widget_caps_word_indicator *w
     sys_slist_append(&widgets, &widget->node);
 
     widget_caps_word_indicator_init();
+
+    LVGL_MEM_ACCOUNT_EXIT();
     return 0;
 }
 
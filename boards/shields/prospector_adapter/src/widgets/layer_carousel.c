@@ -0,0 +1,163 @@
+#include "layer_carousel.h"
+
+#include <lvgl_memory.h>
+#include <ctype.h>
+#include <zmk/display.h>
+#include <zmk/events/layer_state_changed.h>
+#include <zmk/event_manager.h>
+#include <zmk/keymap.h>
+
+#include <fonts.h>
+
+#include "../layer_names.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static LVGL_MEM_ACCOUNT_DEFINE(layer_carousel);
+
+static sys_slist_t widgets = SYS_SLIST_STATIC_INIT(&widgets);
+
+enum { SLOT_PREV, SLOT_CURRENT, SLOT_NEXT };
+
+#define CAROUSEL_ANIM_TIME 100
+#define LAYER_NAME_MAX_LEN 32
+
+struct layer_carousel_state {
+    uint8_t index;
+};
+
+static lv_coord_t carousel_row_height(void) { return lv_font_get_line_height(&FRAC_Regular_48); }
+
+static void set_layer_label(lv_obj_t *label, int index) {
+#if IS_ENABLED(CONFIG_PROSPECTOR_LAYER_ROLLER_ALL_CAPS)
+    const char *layer_name = zmk_display_layer_name(index);
+    char text[LAYER_NAME_MAX_LEN];
+    size_t i = 0;
+
+    for (; layer_name[i] && i < sizeof(text) - 1; i++) {
+        text[i] = toupper((unsigned char)layer_name[i]);
+    }
+    text[i] = '\0';
+
+    lv_label_set_text(label, text);
+#else
+    // Names outlive the label, so it does not need a copy
+    lv_label_set_text_static(label, zmk_display_layer_name(index));
+#endif
+}
+
+// Relabels the three slots around index, then slides the track from where
+// the new current name was shown back to the center
+static void layer_carousel_set_sel(struct zmk_widget_layer_carousel *widget, uint8_t index,
+                                   lv_anim_enable_t anim) {
+    int count = ZMK_KEYMAP_LAYERS_LEN;
+    int forward = (index - widget->index + count) % count;
+    int dir = forward == 0 ? 0 : (forward <= count / 2 ? 1 : -1);
+
+    widget->index = index;
+    set_layer_label(widget->labels[SLOT_PREV], (index + count - 1) % count);
+    set_layer_label(widget->labels[SLOT_CURRENT], index);
+    set_layer_label(widget->labels[SLOT_NEXT], (index + 1) % count);
+
+    lv_anim_del(widget->track, NULL);
+
+    if (anim == LV_ANIM_OFF || dir == 0) {
+        lv_obj_set_y(widget->track, 0);
+        return;
+    }
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, widget->track);
+    lv_anim_set_exec_cb(&a, (lv_anim_exec_xcb_t)lv_obj_set_y);
+    lv_anim_set_values(&a, dir * carousel_row_height(), 0);
+    lv_anim_set_time(&a, CAROUSEL_ANIM_TIME);
+    lv_anim_set_path_cb(&a, lv_anim_path_ease_out);
+    lv_anim_start(&a);
+}
+
+static void layer_carousel_update_cb(struct layer_carousel_state state) {
+    LVGL_MEM_ACCOUNT_ENTER(layer_carousel);
+
+    struct zmk_widget_layer_carousel *widget;
+    SYS_SLIST_FOR_EACH_CONTAINER(&widgets, widget, node) {
+        layer_carousel_set_sel(widget, state.index, LV_ANIM_ON);
+    }
+
+    LVGL_MEM_ACCOUNT_EXIT();
+}
+
+static struct layer_carousel_state layer_carousel_get_state(const zmk_event_t *eh) {
+    uint8_t index = zmk_keymap_highest_layer_active();
+    LOG_INF("Carousel set to: %d", index);
+    return (struct layer_carousel_state){
+        .index = index,
+    };
+}
+
+ZMK_DISPLAY_WIDGET_LISTENER(widget_layer_carousel, struct layer_carousel_state,
+                            layer_carousel_update_cb, layer_carousel_get_state)
+ZMK_SUBSCRIPTION(widget_layer_carousel, zmk_layer_state_changed);
+
+static void fade_event_cb(lv_event_t *e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    struct zmk_widget_layer_carousel *widget = lv_event_get_user_data(e);
+
+    if (code == LV_EVENT_COVER_CHECK) {
+        lv_event_set_cover_res(e, LV_COVER_RES_MASKED);
+    } else if (code == LV_EVENT_DRAW_POST) {
+        row_fade_update(&widget->fade, lv_obj_get_height(widget->obj), carousel_row_height());
+        row_fade_apply(&widget->fade, widget->obj, lv_event_get_draw_ctx(e));
+    }
+}
+
+int zmk_widget_layer_carousel_init(struct zmk_widget_layer_carousel *widget, lv_obj_t *parent) {
+    LVGL_MEM_ACCOUNT_ENTER(layer_carousel);
+
+    lv_coord_t row_h = carousel_row_height();
+
+    widget->obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(widget->obj);
+    lv_obj_clear_flag(widget->obj, LV_OBJ_FLAG_SCROLLABLE);
+
+    widget->track = lv_obj_create(widget->obj);
+    lv_obj_remove_style_all(widget->track);
+    lv_obj_clear_flag(widget->track, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(widget->track, lv_pct(100), 3 * row_h);
+    lv_obj_align(widget->track, LV_ALIGN_LEFT_MID, 0, 0);
+
+    for (int i = 0; i < ARRAY_SIZE(widget->labels); i++) {
+        lv_obj_t *label = lv_label_create(widget->track);
+        lv_obj_set_width(label, lv_pct(100));
+        lv_obj_set_y(label, i * row_h);
+        lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_CENTER, 0);
+        lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
+
+        if (i == SLOT_CURRENT) {
+            lv_obj_set_style_text_font(label, &FRAC_Regular_48, 0);
+            lv_obj_set_style_text_color(label, lv_color_hex(0xffffff), 0);
+        } else {
+            lv_obj_set_style_text_font(label, &FRAC_Thin_48, 0);
+            lv_obj_set_style_text_color(label, lv_color_hex(0x909090), 0);
+        }
+
+        widget->labels[i] = label;
+    }
+
+    widget->index = 0;
+    layer_carousel_set_sel(widget, 0, LV_ANIM_OFF);
+
+    lv_obj_add_event_cb(widget->obj, fade_event_cb, LV_EVENT_ALL, widget);
+
+    sys_slist_append(&widgets, &widget->node);
+
+    widget_layer_carousel_init();
+
+    LVGL_MEM_ACCOUNT_EXIT();
+    return 0;
+}
+
+lv_obj_t *zmk_widget_layer_carousel_obj(struct zmk_widget_layer_carousel *widget) {
+    return widget->obj;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <lvgl.h>
+#include <zephyr/kernel.h>
+
+#include "row_fade.h"
+
+struct zmk_widget_layer_carousel {
+    sys_snode_t node;
+    lv_obj_t *obj;
+    // Holds the previous, current and next name, moved as one to animate
+    lv_obj_t *track;
+    lv_obj_t *labels[3];
+    uint8_t index;
+    struct row_fade fade;
+};
+
+int zmk_widget_layer_carousel_init(struct zmk_widget_layer_carousel *widget, lv_obj_t *parent);
+lv_obj_t *zmk_widget_layer_carousel_obj(struct zmk_widget_layer_carousel *widget);
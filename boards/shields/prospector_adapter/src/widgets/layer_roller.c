@@ -1,6 +1,7 @@
 #include "layer_roller.h"
+#include "row_fade.h"
 
-#include <ctype.h>
+#include <lvgl_memory.h>
 #include <zmk/display.h>
 #include <zmk/events/layer_state_changed.h>
 #include <zmk/event_manager.h>
@@ -8,10 +9,12 @@
 
 #include <fonts.h>
 
+#include "../layer_names.h"
+
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
-static char layer_names_buffer[256] = {0}; // Buffer for concatenated layer names
+static LVGL_MEM_ACCOUNT_DEFINE(layer_roller);
 
 static sys_slist_t widgets = SYS_SLIST_STATIC_INIT(&widgets);
 
@@ -24,10 +27,14 @@ static void layer_roller_set_sel(lv_obj_t *roller, struct layer_roller_state sta
 }
 
 static void layer_roller_update_cb(struct layer_roller_state state) {
+    LVGL_MEM_ACCOUNT_ENTER(layer_roller);
+
     struct zmk_widget_layer_roller *widget;
     SYS_SLIST_FOR_EACH_CONTAINER(&widgets, widget, node) {
         layer_roller_set_sel(widget->obj, state);
     }
+
+    LVGL_MEM_ACCOUNT_EXIT();
 }
 
 static struct layer_roller_state layer_roller_get_state(const zmk_event_t *eh) {
@@ -42,21 +49,29 @@ ZMK_DISPLAY_WIDGET_LISTENER(widget_layer_roller, struct layer_roller_state, laye
                             layer_roller_get_state)
 ZMK_SUBSCRIPTION(widget_layer_roller, zmk_layer_state_changed);
 
-static void mask_event_cb(lv_event_t * e)
-{
+static struct row_fade fade;
+
+// Only set by the benchmark
+static bool use_fade_masks;
+
+#if IS_ENABLED(CONFIG_PROSPECTOR_BENCHMARK)
+static uint32_t draw_cycles;
+static uint32_t draw_start;
+
+void zmk_widget_layer_roller_use_fade_masks(bool enable) { use_fade_masks = enable; }
+
+uint32_t zmk_widget_layer_roller_draw_cycles(void) { return draw_cycles; }
+
+// The gradient masks the fade table replaced, kept to compare render times
+static void fade_masks_event(lv_event_t *e) {
     lv_event_code_t code = lv_event_get_code(e);
-    lv_obj_t * obj = lv_event_get_target(e);
+    lv_obj_t *obj = lv_event_get_target(e);
 
     static int16_t mask_top_id = -1;
     static int16_t mask_bottom_id = -1;
 
-    if(code == LV_EVENT_COVER_CHECK) {
-        lv_event_set_cover_res(e, LV_COVER_RES_MASKED);
-
-    }
-    else if(code == LV_EVENT_DRAW_MAIN_BEGIN) {
-        /* add mask */
-        const lv_font_t * font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    if (code == LV_EVENT_DRAW_MAIN_BEGIN) {
+        const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
         lv_coord_t line_space = lv_obj_get_style_text_line_space(obj, LV_PART_MAIN);
         lv_coord_t font_h = lv_font_get_line_height(font);
 
@@ -69,21 +84,22 @@ static void mask_event_cb(lv_event_t * e)
         rect_area.y1 = roller_coords.y1;
         rect_area.y2 = roller_coords.y1 + (lv_obj_get_height(obj) - font_h - line_space) / 2;
 
-        lv_draw_mask_fade_param_t * fade_mask_top = lv_mem_buf_get(sizeof(lv_draw_mask_fade_param_t));
-        lv_draw_mask_fade_init(fade_mask_top, &rect_area, LV_OPA_TRANSP, rect_area.y1, LV_OPA_COVER, rect_area.y2);
+        lv_draw_mask_fade_param_t *fade_mask_top = lv_mem_buf_get(sizeof(lv_draw_mask_fade_param_t));
+        lv_draw_mask_fade_init(fade_mask_top, &rect_area, LV_OPA_TRANSP, rect_area.y1, LV_OPA_COVER,
+                               rect_area.y2);
         mask_top_id = lv_draw_mask_add(fade_mask_top, NULL);
 
         rect_area.y1 = rect_area.y2 + font_h + line_space - 1;
         rect_area.y2 = roller_coords.y2;
 
-        lv_draw_mask_fade_param_t * fade_mask_bottom = lv_mem_buf_get(sizeof(lv_draw_mask_fade_param_t));
-        lv_draw_mask_fade_init(fade_mask_bottom, &rect_area, LV_OPA_COVER, rect_area.y1, LV_OPA_TRANSP, rect_area.y2);
+        lv_draw_mask_fade_param_t *fade_mask_bottom =
+            lv_mem_buf_get(sizeof(lv_draw_mask_fade_param_t));
+        lv_draw_mask_fade_init(fade_mask_bottom, &rect_area, LV_OPA_COVER, rect_area.y1,
+                               LV_OPA_TRANSP, rect_area.y2);
         mask_bottom_id = lv_draw_mask_add(fade_mask_bottom, NULL);
-
-    }
-    else if(code == LV_EVENT_DRAW_POST_END) {
-        lv_draw_mask_fade_param_t * fade_mask_top = lv_draw_mask_remove_id(mask_top_id);
-        lv_draw_mask_fade_param_t * fade_mask_bottom = lv_draw_mask_remove_id(mask_bottom_id);
+    } else if (code == LV_EVENT_DRAW_POST_END) {
+        lv_draw_mask_fade_param_t *fade_mask_top = lv_draw_mask_remove_id(mask_top_id);
+        lv_draw_mask_fade_param_t *fade_mask_bottom = lv_draw_mask_remove_id(mask_bottom_id);
         lv_draw_mask_free_param(fade_mask_top);
         lv_draw_mask_free_param(fade_mask_bottom);
         lv_mem_buf_release(fade_mask_top);
@@ -92,44 +108,49 @@ static void mask_event_cb(lv_event_t * e)
         mask_bottom_id = -1;
     }
 }
+#endif
 
-int zmk_widget_layer_roller_init(struct zmk_widget_layer_roller *widget, lv_obj_t *parent) {
-    widget->obj = lv_roller_create(parent);
+static void mask_event_cb(lv_event_t * e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t * obj = lv_event_get_target(e);
+
+    if(code == LV_EVENT_COVER_CHECK) {
+        lv_event_set_cover_res(e, LV_COVER_RES_MASKED);
+        return;
+    }
 
-    layer_names_buffer[0] = '\0';
-    char *ptr = layer_names_buffer;
-
-    for (int i = 0; i < ZMK_KEYMAP_LAYERS_LEN; i++) {
-        const char *layer_name = zmk_keymap_layer_name(zmk_keymap_layer_index_to_id(i));
-        if (layer_name) {
-            if (i > 0) {
-                strcat(ptr, "\n");
-                ptr += strlen(ptr);
-            }
-
-            if (layer_name && *layer_name) {
-#if IS_ENABLED(CONFIG_LAYER_ROLLER_ALL_CAPS)
-                while (*layer_name) {
-                    *ptr = toupper((unsigned char)*layer_name);
-                    ptr++;
-                    layer_name++;
-                }
-                *ptr = '\0';
-#else
-                strcat(ptr, layer_name);
-                ptr += strlen(layer_name);
+#if IS_ENABLED(CONFIG_PROSPECTOR_BENCHMARK)
+    if (code == LV_EVENT_DRAW_MAIN_BEGIN) {
+        draw_start = k_cycle_get_32();
+    }
+
+    if (use_fade_masks) {
+        fade_masks_event(e);
+    }
 #endif
-            } else {
-                // Just use the number for unnamed layers
-                char index_str[12];
-                snprintf(index_str, sizeof(index_str), "%d", i);
-                strcat(ptr, index_str);
-                ptr += strlen(index_str);
-            }
-        }
+
+    if(code == LV_EVENT_DRAW_POST && !use_fade_masks) {
+        const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+        lv_coord_t line_space = lv_obj_get_style_text_line_space(obj, LV_PART_MAIN);
+
+        row_fade_update(&fade, lv_obj_get_height(obj), lv_font_get_line_height(font) + line_space);
+        row_fade_apply(&fade, obj, lv_event_get_draw_ctx(e));
+    }
+
+#if IS_ENABLED(CONFIG_PROSPECTOR_BENCHMARK)
+    if (code == LV_EVENT_DRAW_POST_END) {
+        draw_cycles += k_cycle_get_32() - draw_start;
     }
+#endif
+}
 
-    lv_roller_set_options(widget->obj, layer_names_buffer, LV_ROLLER_MODE_INFINITE);
+int zmk_widget_layer_roller_init(struct zmk_widget_layer_roller *widget, lv_obj_t *parent) {
+    LVGL_MEM_ACCOUNT_ENTER(layer_roller);
+
+    widget->obj = lv_roller_create(parent);
+
+    lv_roller_set_options(widget->obj, zmk_display_layer_names_options(), LV_ROLLER_MODE_INFINITE);
 
     static lv_style_t style;
     lv_style_init(&style);
@@ -180,6 +201,8 @@ int zmk_widget_layer_roller_init(struct zmk_widget_layer_roller *widget, lv_obj_
     sys_slist_append(&widgets, &widget->node);
 
     widget_layer_roller_init();
+
+    LVGL_MEM_ACCOUNT_EXIT();
     return 0;
 }
 
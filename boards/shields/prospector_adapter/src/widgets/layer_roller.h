@@ -9,4 +9,11 @@ struct zmk_widget_layer_roller {
 };
 
 int zmk_widget_layer_roller_init(struct zmk_widget_layer_roller *widget, lv_obj_t *parent);
-lv_obj_t *zmk_widget_layer_roller_obj(struct zmk_widget_layer_roller *widget);
\ No newline at end of file
+lv_obj_t *zmk_widget_layer_roller_obj(struct zmk_widget_layer_roller *widget);
+
+#if IS_ENABLED(CONFIG_PROSPECTOR_BENCHMARK)
+// Switch back to the per-draw gradient masks, to compare render times
+void zmk_widget_layer_roller_use_fade_masks(bool enable);
+// Cycles spent drawing the roller since boot
+uint32_t zmk_widget_layer_roller_draw_cycles(void);
+#endif
@@ -0,0 +1,62 @@
+#include "row_fade.h"
+
+#include <zephyr/sys/util.h>
+
+static lv_opa_t row_fade_ramp(lv_coord_t y, lv_coord_t y_from, lv_opa_t opa_from, lv_coord_t y_to,
+                              lv_opa_t opa_to) {
+    if (y_to <= y_from) {
+        return opa_to;
+    }
+    return opa_from + (int32_t)(opa_to - opa_from) * (y - y_from) / (y_to - y_from);
+}
+
+void row_fade_update(struct row_fade *fade, lv_coord_t height, lv_coord_t band_h) {
+    if (height == fade->height && band_h == fade->band_h) {
+        return;
+    }
+
+    fade->height = height;
+    fade->band_h = band_h;
+
+    lv_coord_t top_end = (height - band_h) / 2;
+    lv_coord_t bottom_start = top_end + band_h - 1;
+
+    for (lv_coord_t y = 0; y < MIN(height, ROW_FADE_MAX_ROWS); y++) {
+        if (y <= top_end) {
+            fade->opa[y] = row_fade_ramp(y, 0, LV_OPA_TRANSP, top_end, LV_OPA_COVER);
+        } else if (y >= bottom_start) {
+            fade->opa[y] = row_fade_ramp(y, bottom_start, LV_OPA_COVER, height - 1, LV_OPA_TRANSP);
+        } else {
+            fade->opa[y] = LV_OPA_COVER;
+        }
+    }
+}
+
+void row_fade_apply(const struct row_fade *fade, lv_obj_t *obj, lv_draw_ctx_t *draw_ctx) {
+    lv_area_t coords;
+    lv_area_t area;
+
+    lv_obj_get_coords(obj, &coords);
+    if (!_lv_area_intersect(&area, &coords, draw_ctx->clip_area)) {
+        return;
+    }
+
+    lv_color_t *buf = draw_ctx->buf;
+    lv_coord_t stride = lv_area_get_width(draw_ctx->buf_area);
+    lv_coord_t width = lv_area_get_width(&area);
+
+    for (lv_coord_t y = area.y1; y <= area.y2; y++) {
+        lv_coord_t row = y - coords.y1;
+        lv_opa_t opa = row < ROW_FADE_MAX_ROWS ? fade->opa[row] : LV_OPA_COVER;
+
+        if (opa >= LV_OPA_MAX) {
+            continue;
+        }
+
+        lv_color_t *px = buf + (y - draw_ctx->buf_area->y1) * stride +
+                         (area.x1 - draw_ctx->buf_area->x1);
+        for (lv_coord_t x = 0; x < width; x++) {
+            px[x] = lv_color_mix(px[x], lv_color_black(), opa);
+        }
+    }
+}
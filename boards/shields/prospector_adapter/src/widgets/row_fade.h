@@ -0,0 +1,21 @@
+#pragma once
+
+#include <lvgl.h>
+
+#define ROW_FADE_MAX_ROWS 320
+
+// Opacity of each row of a widget that fades out above and below a centered
+// band, towards the black screen background. Rebuilt only when the geometry
+// changes, then applied to the rendered rows in place of gradient masks,
+// which would run over every pixel of every redraw.
+struct row_fade {
+    lv_coord_t height;
+    lv_coord_t band_h;
+    lv_opa_t opa[ROW_FADE_MAX_ROWS];
+};
+
+// Rebuilds the table if the widget height or band height changed
+void row_fade_update(struct row_fade *fade, lv_coord_t height, lv_coord_t band_h);
+
+// Fades the rows of obj in the draw buffer, call from LV_EVENT_DRAW_POST
+void row_fade_apply(const struct row_fade *fade, lv_obj_t *obj, lv_draw_ctx_t *draw_ctx);
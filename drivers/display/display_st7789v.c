@@ -12,6 +12,9 @@
 #define DT_DRV_COMPAT sitronix_st7789v
 
 #include "display_st7789v.h"
+#include "st7789v_pack.h"
+
+#include <drivers/display/st7789v.h>
 
 #include <zephyr/device.h>
 #include <zephyr/drivers/spi.h>
@@ -19,7 +22,11 @@
 #include <zephyr/drivers/display.h>
 #include <zephyr/pm/device.h>
 #include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/drivers/display.h>
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
 
 #define LOG_LEVEL CONFIG_DISPLAY_LOG_LEVEL
 #include <zephyr/logging/log.h>
@@ -47,20 +54,125 @@ struct st7789v_config {
 	uint8_t rgb_param[3];
 	uint16_t height;
 	uint16_t width;
+	/* Panel position in controller RAM at the normal orientation */
+	uint16_t x_offset;
+	uint16_t y_offset;
+};
+
+/* Only instances wired without a CMD/DATA line need the 9-bit packing buffer */
+#define ST7789V_INST_USES_9BIT(inst) !DT_INST_NODE_HAS_PROP(inst, cmd_data_gpios) ||
+#define ST7789V_USES_9BIT (DT_INST_FOREACH_STATUS_OKAY(ST7789V_INST_USES_9BIT) 0)
+
+/* Data bytes packed per transfer in 9-bit mode, must be a multiple of 8 */
+#define ST7789V_9BIT_CHUNK_SIZE 512u
+
+/* Packed RGB444 bytes staged per transfer, 640 pixels, must be a multiple of 3 */
+#define ST7789V_RGB444_CHUNK_SIZE 960u
+
+/* Rows of a strided write gathered into a single SPI transaction */
+#define ST7789V_MAX_ROW_BUFS 32
+
+#define ST7789V_HAS_TE DT_HAS_COMPAT_STATUS_OKAY(zmk_st7789v_te)
+
+/* Gate lines the panel scans per frame, porches ignored */
+#define ST7789V_GRAM_ROWS 320u
+/* Frame period at the FRCTRL2 reset value of 60 Hz */
+#define ST7789V_DEFAULT_FRAME_PERIOD_US 16667u
+/* Internal oscillator the normal mode frame rate is derived from */
+#define ST7789V_OSC_HZ 10000000u
+/* Give up waiting for TE after this many frame periods */
+#define ST7789V_TE_TIMEOUT_FRAMES 2
+
+#if ST7789V_HAS_TE
+struct st7789v_te_line {
+	const struct device *display;
+	struct gpio_dt_spec gpio;
 };
 
+#define ST7789V_TE_LINE(node)                                                                      \
+	{                                                                                          \
+		.display = DEVICE_DT_GET(DT_PHANDLE(node, display)),                               \
+		.gpio = GPIO_DT_SPEC_GET(node, te_gpios),                                          \
+	},
+
+static const struct st7789v_te_line st7789v_te_lines[] = {
+	DT_FOREACH_STATUS_OKAY(zmk_st7789v_te, ST7789V_TE_LINE)};
+#endif /* ST7789V_HAS_TE */
+
 struct st7789v_data {
 	uint16_t x_offset;
 	uint16_t y_offset;
 	enum display_orientation orientation;
+	/* Holds CS and the bus between the transactions of a command batch */
+	struct spi_config batch_config;
+	/* Last programmed CASET/RASET parameters, big endian */
+	uint16_t window[4];
+	bool window_valid;
+	struct st7789v_window_stats window_stats;
+	/* Pixel data scatter list, must outlive an asynchronous transfer */
+	struct spi_buf row_bufs[ST7789V_MAX_ROW_BUFS];
+	struct spi_buf_set row_buf_set;
+	/* FRCTRL2 parameter and the frame period it results in */
+	uint8_t frctrl2;
+	uint32_t frame_period_us;
+#if ST7789V_HAS_TE
+	const struct gpio_dt_spec *te_gpio;
+	struct gpio_callback te_cb;
+	struct k_sem te_sem;
+	/* Set by st7789v_frame_begin(), the next write waits for TE */
+	bool te_armed;
+	bool te_warned;
+#endif
+	/* No TE edges arrive while the panel is off or asleep */
+	bool blanked;
+	bool suspended;
+#if ST7789V_USES_9BIT
+	/* 8-bit word view of the bus to stream packed 9-bit data */
+	struct spi_config packed_config;
+	uint8_t packed_buf[ST7789V_9BIT_CHUNK_SIZE / ST7789V_9BIT_GROUP_LEN *
+			   ST7789V_9BIT_GROUP_SIZE];
+#endif
+#ifdef CONFIG_ST7789V_RGB444
+	uint8_t rgb444_buf[ST7789V_RGB444_CHUNK_SIZE];
+#endif
+#ifdef CONFIG_ST7789V_STATS
+	struct st7789v_stats stats;
+	uint32_t async_start;
+	bool crc_enabled;
+	uint32_t crc;
+#endif
+#ifdef CONFIG_ST7789V_ASYNC_WRITE
+	/* Held while a transfer is on the bus, released by the SPI callback */
+	struct k_sem bus_lock;
+	st7789v_write_done_cb_t write_done_cb;
+	void *write_done_user_data;
+#endif
 };
 
-#ifdef CONFIG_ST7789V_RGB565
+/* Size of a pixel in the write buffer, RGB444 is packed by the driver */
+#if defined(CONFIG_ST7789V_RGB565) || defined(CONFIG_ST7789V_RGB444)
 #define ST7789V_PIXEL_SIZE 2u
 #else
 #define ST7789V_PIXEL_SIZE 3u
 #endif
 
+/* Large enough for the init sequence, the biggest batch the driver builds */
+#define ST7789V_BATCH_MAX_CMDS 20
+/* 9-bit words staged per transaction when there is no CMD/DATA line */
+#define ST7789V_BATCH_MAX_WORDS 64
+
+struct st7789v_cmd {
+	uint8_t cmd;
+	uint8_t len;
+	/* Not copied, must stay valid until the batch is flushed */
+	const uint8_t *params;
+};
+
+struct st7789v_batch {
+	struct st7789v_cmd cmds[ST7789V_BATCH_MAX_CMDS];
+	size_t count;
+};
+
 static void st7789v_set_lcd_margins(const struct device *dev, uint16_t x_offset, uint16_t y_offset)
 {
 	struct st7789v_data *data = dev->data;
@@ -69,6 +181,74 @@ static void st7789v_set_lcd_margins(const struct device *dev, uint16_t x_offset,
 	data->y_offset = y_offset;
 }
 
+#ifdef CONFIG_ST7789V_STATS
+static uint32_t st7789v_buf_set_len(const struct spi_buf_set *bufs)
+{
+	uint32_t len = 0;
+
+	for (size_t i = 0; i < bufs->count; i++) {
+		len += bufs->buffers[i].len;
+	}
+
+	return len;
+}
+#endif
+
+static void st7789v_spi_write(const struct device *dev, const struct spi_config *spi_config,
+			      const struct spi_buf_set *bufs)
+{
+	const struct st7789v_config *config = dev->config;
+
+#ifdef CONFIG_ST7789V_STATS
+	struct st7789v_data *data = dev->data;
+	uint32_t start = k_cycle_get_32();
+
+	spi_write(config->bus.bus, spi_config, bufs);
+
+	data->stats.spi_cycles += k_cycle_get_32() - start;
+	data->stats.transactions++;
+	data->stats.bytes += st7789v_buf_set_len(bufs);
+#else
+	spi_write(config->bus.bus, spi_config, bufs);
+#endif
+}
+
+#if ST7789V_USES_9BIT
+static void st7789v_transmit_9bit_data(const struct device *dev, const uint8_t *tx_data,
+				       size_t tx_count)
+{
+	const struct st7789v_config *config = dev->config;
+	struct st7789v_data *data = dev->data;
+	size_t packed_count = tx_count - (tx_count % ST7789V_9BIT_GROUP_LEN);
+	uint16_t words[ST7789V_9BIT_GROUP_LEN - 1];
+
+	struct spi_buf tx_buf = {.buf = data->packed_buf};
+	struct spi_buf_set tx_bufs = {.buffers = &tx_buf, .count = 1};
+
+	while (packed_count > 0) {
+		size_t chunk = MIN(packed_count, ST7789V_9BIT_CHUNK_SIZE);
+
+		st7789v_pack_9bit(data->packed_buf, tx_data, chunk);
+
+		tx_buf.len = chunk / ST7789V_9BIT_GROUP_LEN * ST7789V_9BIT_GROUP_SIZE;
+		st7789v_spi_write(dev, &data->packed_config, &tx_bufs);
+
+		tx_data += chunk;
+		tx_count -= chunk;
+		packed_count -= chunk;
+	}
+
+	/* A partial group would leave stray bits on the wire, send it as words */
+	if (tx_count > 0) {
+		st7789v_pack_9bit_words(words, tx_data, tx_count);
+
+		tx_buf.buf = words;
+		tx_buf.len = tx_count * sizeof(words[0]);
+		st7789v_spi_write(dev, &config->bus.config, &tx_bufs);
+	}
+}
+#endif /* ST7789V_USES_9BIT */
+
 static void st7789v_transmit(const struct device *dev, uint8_t cmd, uint8_t *tx_data,
 			     size_t tx_count)
 {
@@ -81,32 +261,268 @@ static void st7789v_transmit(const struct device *dev, uint8_t cmd, uint8_t *tx_
 	if (config->cmd_data_gpio.port != NULL) {
 		if (cmd != ST7789V_CMD_NONE) {
 			gpio_pin_set_dt(&config->cmd_data_gpio, 1);
-			spi_write_dt(&config->bus, &tx_bufs);
+			st7789v_spi_write(dev, &config->bus.config, &tx_bufs);
 		}
 
 		if (tx_data != NULL) {
 			tx_buf.buf = tx_data;
 			tx_buf.len = tx_count;
 			gpio_pin_set_dt(&config->cmd_data_gpio, 0);
-			spi_write_dt(&config->bus, &tx_bufs);
+			st7789v_spi_write(dev, &config->bus.config, &tx_bufs);
 		}
 	} else {
 		tx_buf.buf = &data;
 		tx_buf.len = 2;
 
 		if (cmd != ST7789V_CMD_NONE) {
-			spi_write_dt(&config->bus, &tx_bufs);
+			st7789v_spi_write(dev, &config->bus.config, &tx_bufs);
 		}
 
+#if ST7789V_USES_9BIT
 		if (tx_data != NULL) {
-			for (size_t index = 0; index < tx_count; ++index) {
-				data = 0x0100 | tx_data[index];
-				spi_write_dt(&config->bus, &tx_bufs);
+			st7789v_transmit_9bit_data(dev, tx_data, tx_count);
+		}
+#endif
+	}
+}
+
+static void st7789v_batch_add(struct st7789v_batch *batch, uint8_t cmd, const uint8_t *params,
+			      size_t len)
+{
+	__ASSERT(batch->count < ARRAY_SIZE(batch->cmds), "Command batch is full");
+	__ASSERT(len <= UINT8_MAX, "Too many command parameters");
+
+	batch->cmds[batch->count++] = (struct st7789v_cmd){
+		.cmd = cmd,
+		.len = len,
+		.params = params,
+	};
+}
+
+/*
+ * Sends all queued commands under a single chip select assertion. With a
+ * CMD/DATA line every command and parameter block is still its own transfer
+ * since the line has to toggle in between, but CS and the bus lock are held
+ * throughout. In 9-bit mode the D/C bit travels with each word, so the whole
+ * batch is staged and sent in as few transfers as the staging buffer allows.
+ */
+static void st7789v_batch_flush(const struct device *dev, struct st7789v_batch *batch)
+{
+	const struct st7789v_config *config = dev->config;
+	struct st7789v_data *data = dev->data;
+	struct spi_buf tx_buf;
+	struct spi_buf_set tx_bufs = {.buffers = &tx_buf, .count = 1};
+
+	if (config->cmd_data_gpio.port != NULL) {
+		for (size_t i = 0; i < batch->count; i++) {
+			const struct st7789v_cmd *entry = &batch->cmds[i];
+
+			tx_buf.buf = (void *)&entry->cmd;
+			tx_buf.len = 1;
+			gpio_pin_set_dt(&config->cmd_data_gpio, 1);
+			st7789v_spi_write(dev, &data->batch_config, &tx_bufs);
+
+			if (entry->len > 0) {
+				tx_buf.buf = (void *)entry->params;
+				tx_buf.len = entry->len;
+				gpio_pin_set_dt(&config->cmd_data_gpio, 0);
+				st7789v_spi_write(dev, &data->batch_config, &tx_bufs);
+			}
+		}
+	} else {
+		uint16_t words[ST7789V_BATCH_MAX_WORDS];
+		size_t count = 0;
+
+		tx_buf.buf = words;
+
+		for (size_t i = 0; i < batch->count; i++) {
+			const struct st7789v_cmd *entry = &batch->cmds[i];
+
+			if (count + 1 + entry->len > ARRAY_SIZE(words)) {
+				tx_buf.len = count * sizeof(words[0]);
+				st7789v_spi_write(dev, &data->batch_config, &tx_bufs);
+				count = 0;
+			}
+
+			words[count++] = entry->cmd;
+			for (size_t j = 0; j < entry->len; j++) {
+				words[count++] = 0x0100 | entry->params[j];
 			}
 		}
+
+		if (count > 0) {
+			tx_buf.len = count * sizeof(words[0]);
+			st7789v_spi_write(dev, &data->batch_config, &tx_bufs);
+		}
+	}
+
+	spi_release(config->bus.bus, &data->batch_config);
+	batch->count = 0;
+}
+
+/* Points the scatter list at up to ST7789V_MAX_ROW_BUFS rows of pixel data */
+static void st7789v_gather_rows(const struct device *dev, const uint8_t *start,
+				const struct display_buffer_descriptor *desc, uint16_t rows)
+{
+	struct st7789v_data *data = dev->data;
+
+	__ASSERT(rows <= ARRAY_SIZE(data->row_bufs), "Too many rows to gather");
+
+	if (desc->pitch == desc->width) {
+		data->row_bufs[0].buf = (void *)start;
+		data->row_bufs[0].len = desc->width * ST7789V_PIXEL_SIZE * rows;
+		data->row_buf_set.count = 1;
+	} else {
+		for (uint16_t row = 0; row < rows; row++) {
+			data->row_bufs[row].buf = (void *)start;
+			data->row_bufs[row].len = desc->width * ST7789V_PIXEL_SIZE;
+			start += desc->pitch * ST7789V_PIXEL_SIZE;
+		}
+		data->row_buf_set.count = rows;
 	}
+
+	data->row_buf_set.buffers = data->row_bufs;
 }
 
+/*
+ * Sends a strided area with one buffer per row. Rows are gathered in groups
+ * of ST7789V_MAX_ROW_BUFS, with CS held across the groups so the whole area
+ * still goes out under a single chip select assertion.
+ */
+static void st7789v_transmit_rows(const struct device *dev, const uint8_t *start,
+				  const struct display_buffer_descriptor *desc)
+{
+	const struct st7789v_config *config = dev->config;
+	struct st7789v_data *data = dev->data;
+
+	gpio_pin_set_dt(&config->cmd_data_gpio, 0);
+
+	for (uint16_t row = 0; row < desc->height; row += ST7789V_MAX_ROW_BUFS) {
+		uint16_t rows = MIN(desc->height - row, ST7789V_MAX_ROW_BUFS);
+
+		st7789v_gather_rows(dev, start, desc, rows);
+		st7789v_spi_write(dev, &data->batch_config, &data->row_buf_set);
+		start += rows * desc->pitch * ST7789V_PIXEL_SIZE;
+	}
+
+	spi_release(config->bus.bus, &data->batch_config);
+}
+
+#ifdef CONFIG_ST7789V_RGB444
+/* Converts an area through the staging buffer, see st7789v_pack_rgb444() */
+static void st7789v_transmit_rgb444(const struct device *dev, const uint8_t *start,
+				    const struct display_buffer_descriptor *desc)
+{
+	struct st7789v_data *data = dev->data;
+	struct st7789v_rgb444_area area = {
+		.buf = start,
+		.width = desc->width,
+		.height = desc->height,
+		.pitch = desc->pitch,
+	};
+	size_t len;
+
+	while ((len = st7789v_pack_rgb444(&area, data->rgb444_buf, sizeof(data->rgb444_buf))) >
+	       0) {
+		st7789v_transmit(dev, ST7789V_CMD_NONE, data->rgb444_buf, len);
+	}
+}
+#endif /* CONFIG_ST7789V_RGB444 */
+
+#ifdef CONFIG_ST7789V_ASYNC_WRITE
+static void st7789v_bus_acquire(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+
+	k_sem_take(&data->bus_lock, K_FOREVER);
+}
+
+static void st7789v_bus_release(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+
+	k_sem_give(&data->bus_lock);
+}
+
+static void st7789v_stats_write_end(const struct device *dev);
+
+static void st7789v_write_done(const struct device *spi_dev, int result, void *user_data)
+{
+	const struct device *dev = user_data;
+	struct st7789v_data *data = dev->data;
+
+	ARG_UNUSED(spi_dev);
+
+	if (result < 0) {
+		LOG_ERR("Async pixel transfer failed (%d)", result);
+	}
+
+#ifdef CONFIG_ST7789V_STATS
+	data->stats.spi_cycles += k_cycle_get_32() - data->async_start;
+#endif
+	st7789v_stats_write_end(dev);
+
+	st7789v_bus_release(dev);
+
+	if (data->write_done_cb != NULL) {
+		data->write_done_cb(dev, data->write_done_user_data);
+	}
+}
+
+/* Starts RAMWR pixel data as a non-blocking transaction, bus lock must be held */
+static int st7789v_transmit_async(const struct device *dev, const uint8_t *start,
+				  const struct display_buffer_descriptor *desc)
+{
+	const struct st7789v_config *config = dev->config;
+	struct st7789v_data *data = dev->data;
+
+	st7789v_gather_rows(dev, start, desc, desc->height);
+
+#ifdef CONFIG_ST7789V_STATS
+	data->async_start = k_cycle_get_32();
+	data->stats.transactions++;
+	data->stats.bytes += st7789v_buf_set_len(&data->row_buf_set);
+#endif
+
+	gpio_pin_set_dt(&config->cmd_data_gpio, 0);
+	return spi_transceive_cb(config->bus.bus, &config->bus.config, &data->row_buf_set, NULL,
+				 st7789v_write_done, (void *)dev);
+}
+
+int st7789v_set_write_done_cb(const struct device *dev, st7789v_write_done_cb_t cb,
+			      void *user_data)
+{
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
+	data->write_done_cb = cb;
+	data->write_done_user_data = user_data;
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+#else
+static inline void st7789v_bus_acquire(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static inline void st7789v_bus_release(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+int st7789v_set_write_done_cb(const struct device *dev, st7789v_write_done_cb_t cb,
+			      void *user_data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(user_data);
+
+	return -ENOTSUP;
+}
+#endif /* CONFIG_ST7789V_ASYNC_WRITE */
+
 static void st7789v_exit_sleep(const struct device *dev)
 {
 	st7789v_transmit(dev, ST7789V_CMD_SLEEP_OUT, NULL, 0);
@@ -132,62 +548,442 @@ static void st7789v_reset_display(const struct device *dev)
 
 static int st7789v_blanking_on(const struct device *dev)
 {
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
 	st7789v_transmit(dev, ST7789V_CMD_DISP_OFF, NULL, 0);
+	data->blanked = true;
+	st7789v_bus_release(dev);
 	return 0;
 }
 
 static int st7789v_blanking_off(const struct device *dev)
 {
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
 	st7789v_transmit(dev, ST7789V_CMD_DISP_ON, NULL, 0);
+	data->blanked = false;
+	st7789v_bus_release(dev);
 	return 0;
 }
 
-static void st7789v_set_mem_area(const struct device *dev, const uint16_t x, const uint16_t y,
-				 const uint16_t w, const uint16_t h)
+/*
+ * Only queues the CASET/RASET commands whose range differs from what the
+ * panel already holds, RAMWR always restarts at the start of the window.
+ */
+static void st7789v_set_mem_area(const struct device *dev, struct st7789v_batch *batch,
+				 const uint16_t x, const uint16_t y, const uint16_t w,
+				 const uint16_t h)
 {
 	struct st7789v_data *data = dev->data;
-	uint16_t spi_data[2];
+	uint16_t spi_data[4];
 
 	uint16_t ram_x = x + data->x_offset;
 	uint16_t ram_y = y + data->y_offset;
 
 	spi_data[0] = sys_cpu_to_be16(ram_x);
 	spi_data[1] = sys_cpu_to_be16(ram_x + w - 1);
-	st7789v_transmit(dev, ST7789V_CMD_CASET, (uint8_t *)&spi_data[0], 4);
+	spi_data[2] = sys_cpu_to_be16(ram_y);
+	spi_data[3] = sys_cpu_to_be16(ram_y + h - 1);
+
+	if (!data->window_valid || memcmp(&data->window[0], &spi_data[0], 4) != 0) {
+		memcpy(&data->window[0], &spi_data[0], 4);
+		st7789v_batch_add(batch, ST7789V_CMD_CASET, (uint8_t *)&data->window[0], 4);
+		data->window_stats.caset_sent++;
+	} else {
+		data->window_stats.caset_elided++;
+	}
+
+	if (!data->window_valid || memcmp(&data->window[2], &spi_data[2], 4) != 0) {
+		memcpy(&data->window[2], &spi_data[2], 4);
+		st7789v_batch_add(batch, ST7789V_CMD_RASET, (uint8_t *)&data->window[2], 4);
+		data->window_stats.raset_sent++;
+	} else {
+		data->window_stats.raset_elided++;
+	}
+
+	data->window_valid = true;
+}
+
+int st7789v_get_window_stats(const struct device *dev, struct st7789v_window_stats *stats)
+{
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
+	*stats = data->window_stats;
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+
+int st7789v_get_window(const struct device *dev, uint16_t window[4])
+{
+	struct st7789v_data *data = dev->data;
+	int ret = -ENODATA;
+
+	st7789v_bus_acquire(dev);
+	if (data->window_valid) {
+		for (int i = 0; i < 4; i++) {
+			window[i] = sys_be16_to_cpu(data->window[i]);
+		}
+		ret = 0;
+	}
+	st7789v_bus_release(dev);
 
-	spi_data[0] = sys_cpu_to_be16(ram_y);
-	spi_data[1] = sys_cpu_to_be16(ram_y + h - 1);
-	st7789v_transmit(dev, ST7789V_CMD_RASET, (uint8_t *)&spi_data[0], 4);
+	return ret;
 }
 
+/* Gate lines the panel scans for a window, given the MADCTL in use */
+static void st7789v_scan_range(const struct device *dev, uint16_t x, uint16_t y, uint16_t w,
+			       uint16_t h, uint16_t *first, uint16_t *last)
+{
+	struct st7789v_data *data = dev->data;
+	uint16_t start;
+	uint16_t len;
+	bool reversed;
+
+	switch (data->orientation) {
+	case DISPLAY_ORIENTATION_ROTATED_90:
+		start = x + data->x_offset;
+		len = w;
+		reversed = true;
+		break;
+	case DISPLAY_ORIENTATION_ROTATED_180:
+		start = y + data->y_offset;
+		len = h;
+		reversed = true;
+		break;
+	case DISPLAY_ORIENTATION_ROTATED_270:
+		start = x + data->x_offset;
+		len = w;
+		reversed = false;
+		break;
+	default:
+		start = y + data->y_offset;
+		len = h;
+		reversed = false;
+		break;
+	}
+
+	start = MIN(start, ST7789V_GRAM_ROWS - 1);
+	len = CLAMP(len, 1, ST7789V_GRAM_ROWS - start);
+
+	if (reversed) {
+		*first = ST7789V_GRAM_ROWS - (start + len);
+		*last = ST7789V_GRAM_ROWS - 1 - start;
+	} else {
+		*first = start;
+		*last = start + len - 1;
+	}
+}
+
+#ifdef CONFIG_ST7789V_STATS
+/* Area sizes bucketed in powers of four pixels, starting below 64 */
+static uint8_t st7789v_stats_area_bucket(uint32_t pixels)
+{
+	uint8_t bucket = 0;
+
+	for (uint32_t limit = 64; pixels >= limit && bucket < ST7789V_STATS_AREA_BUCKETS - 1;
+	     limit *= 4) {
+		bucket++;
+	}
+
+	return bucket;
+}
+
+static void st7789v_stats_write_begin(const struct device *dev,
+				      const struct display_buffer_descriptor *desc,
+				      const uint8_t *buf)
+{
+	struct st7789v_data *data = dev->data;
+
+	if (data->crc_enabled) {
+		for (uint16_t row = 0; row < desc->height; row++) {
+			data->crc = crc32_ieee_update(data->crc,
+						      buf + row * desc->pitch * ST7789V_PIXEL_SIZE,
+						      desc->width * ST7789V_PIXEL_SIZE);
+		}
+	}
+
+	data->stats.writes++;
+	data->stats.pixels += desc->width * desc->height;
+	data->stats.area_hist[st7789v_stats_area_bucket(desc->width * desc->height)]++;
+	data->stats.write_start = k_cycle_get_32();
+}
+
+static void st7789v_stats_write_end(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+	uint32_t cycles = k_cycle_get_32() - data->stats.write_start;
+
+	data->stats.write_cycles += cycles;
+	data->stats.max_write_cycles = MAX(data->stats.max_write_cycles, cycles);
+}
+
+static void st7789v_stats_te_wait(const struct device *dev, uint32_t start, bool timed_out)
+{
+	struct st7789v_data *data = dev->data;
+
+	data->stats.te_waits++;
+	data->stats.te_timeouts += timed_out ? 1 : 0;
+	data->stats.te_wait_cycles += k_cycle_get_32() - start;
+}
+
+int st7789v_get_stats(const struct device *dev, struct st7789v_stats *stats)
+{
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
+	*stats = data->stats;
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+
+int st7789v_reset_stats(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
+	memset(&data->stats, 0, sizeof(data->stats));
+	memset(&data->window_stats, 0, sizeof(data->window_stats));
+	data->stats.reset_time = k_uptime_get();
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+
+int st7789v_crc_start(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
+	data->crc = 0;
+	data->crc_enabled = true;
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+
+int st7789v_crc_stop(const struct device *dev, uint32_t *crc)
+{
+	struct st7789v_data *data = dev->data;
+
+	st7789v_bus_acquire(dev);
+	data->crc_enabled = false;
+	*crc = data->crc;
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+#else
+static inline void st7789v_stats_write_begin(const struct device *dev,
+					     const struct display_buffer_descriptor *desc,
+					     const uint8_t *buf)
+{
+}
+
+static inline void st7789v_stats_write_end(const struct device *dev)
+{
+}
+
+static inline void st7789v_stats_te_wait(const struct device *dev, uint32_t start,
+					 bool timed_out)
+{
+}
+
+int st7789v_get_stats(const struct device *dev, struct st7789v_stats *stats)
+{
+	return -ENOTSUP;
+}
+
+int st7789v_reset_stats(const struct device *dev)
+{
+	return -ENOTSUP;
+}
+
+int st7789v_crc_start(const struct device *dev)
+{
+	return -ENOTSUP;
+}
+
+int st7789v_crc_stop(const struct device *dev, uint32_t *crc)
+{
+	return -ENOTSUP;
+}
+#endif /* CONFIG_ST7789V_STATS */
+
+#if ST7789V_HAS_TE
+static void st7789v_te_handler(const struct device *port, struct gpio_callback *cb,
+			       gpio_port_pins_t pins)
+{
+	struct st7789v_data *data = CONTAINER_OF(cb, struct st7789v_data, te_cb);
+
+	ARG_UNUSED(port);
+	ARG_UNUSED(pins);
+
+	k_sem_give(&data->te_sem);
+}
+
+static int st7789v_te_init(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+
+	data->te_gpio = NULL;
+	for (size_t i = 0; i < ARRAY_SIZE(st7789v_te_lines); i++) {
+		if (st7789v_te_lines[i].display == dev) {
+			data->te_gpio = &st7789v_te_lines[i].gpio;
+			break;
+		}
+	}
+
+	if (data->te_gpio == NULL) {
+		return 0;
+	}
+
+	k_sem_init(&data->te_sem, 0, 1);
+
+	if (!gpio_is_ready_dt(data->te_gpio)) {
+		LOG_ERR("TE GPIO device not ready");
+		return -ENODEV;
+	}
+
+	if (gpio_pin_configure_dt(data->te_gpio, GPIO_INPUT)) {
+		LOG_ERR("Couldn't configure TE pin");
+		return -EIO;
+	}
+
+	gpio_init_callback(&data->te_cb, st7789v_te_handler, BIT(data->te_gpio->pin));
+	if (gpio_add_callback_dt(data->te_gpio, &data->te_cb) ||
+	    gpio_pin_interrupt_configure_dt(data->te_gpio, GPIO_INT_EDGE_TO_ACTIVE)) {
+		LOG_ERR("Couldn't configure TE interrupt");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+int st7789v_frame_begin(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+
+	if (data->te_gpio == NULL) {
+		return -ENOTSUP;
+	}
+
+	data->te_armed = true;
+
+	return 0;
+}
+
+/*
+ * Waits for the start of vertical blanking before the first write of a frame.
+ * Called without the bus held, so an outstanding transfer can still complete.
+ * A missing edge disarms the wait for the rest of the frame.
+ */
+static void st7789v_te_wait(const struct device *dev)
+{
+	struct st7789v_data *data = dev->data;
+	uint32_t start;
+	int ret;
+
+	if (!data->te_armed) {
+		return;
+	}
+
+	data->te_armed = false;
+	if (data->blanked || data->suspended) {
+		return;
+	}
+
+	start = k_cycle_get_32();
+	k_sem_reset(&data->te_sem);
+	ret = k_sem_take(&data->te_sem, K_USEC(ST7789V_TE_TIMEOUT_FRAMES * data->frame_period_us));
+	st7789v_stats_te_wait(dev, start, ret != 0);
+	if (ret != 0) {
+		if (!data->te_warned) {
+			LOG_WRN("No TE edge, writing unsynchronized");
+			data->te_warned = true;
+		}
+		return;
+	}
+
+	data->te_warned = false;
+}
+#else
+int st7789v_frame_begin(const struct device *dev)
+{
+	return -ENOTSUP;
+}
+
+static inline void st7789v_te_wait(const struct device *dev)
+{
+}
+#endif /* ST7789V_HAS_TE */
+
 static int st7789v_write(const struct device *dev, const uint16_t x, const uint16_t y,
 			 const struct display_buffer_descriptor *desc, const void *buf)
 {
+	const struct st7789v_config *config __maybe_unused = dev->config;
+	struct st7789v_data *data __maybe_unused = dev->data;
 	const uint8_t *write_data_start = (uint8_t *)buf;
-	uint16_t nbr_of_writes;
-	uint16_t write_h;
+	struct st7789v_batch batch = {0};
 
 	__ASSERT(desc->width <= desc->pitch, "Pitch is smaller then width");
 	__ASSERT((desc->pitch * ST7789V_PIXEL_SIZE * desc->height) <= desc->buf_size,
 		 "Input buffer too small");
 
 	LOG_DBG("Writing %dx%d (w,h) @ %dx%d (x,y)", desc->width, desc->height, x, y);
-	st7789v_set_mem_area(dev, x, y, desc->width, desc->height);
+	st7789v_te_wait(dev);
+	st7789v_bus_acquire(dev);
+	st7789v_stats_write_begin(dev, desc, write_data_start);
+	st7789v_set_mem_area(dev, &batch, x, y, desc->width, desc->height);
+	st7789v_batch_add(&batch, ST7789V_CMD_RAMWR, NULL, 0);
+	st7789v_batch_flush(dev, &batch);
+
+#ifdef CONFIG_ST7789V_RGB444
+	st7789v_transmit_rgb444(dev, write_data_start, desc);
+#else
+#ifdef CONFIG_ST7789V_ASYNC_WRITE
+	if (data->write_done_cb != NULL && config->cmd_data_gpio.port != NULL &&
+	    (desc->pitch == desc->width || desc->height <= ST7789V_MAX_ROW_BUFS)) {
+		int ret;
+
+		/* The completion callback ends the write time and releases the bus */
+		ret = st7789v_transmit_async(dev, write_data_start, desc);
+		if (ret < 0) {
+			LOG_ERR("Failed to start async pixel transfer (%d)", ret);
+			st7789v_stats_write_end(dev);
+			st7789v_bus_release(dev);
+		}
 
-	if (desc->pitch > desc->width) {
-		write_h = 1U;
-		nbr_of_writes = desc->height;
+		return ret;
+	}
+#endif
+
+	if (desc->pitch == desc->width) {
+		st7789v_transmit(dev, ST7789V_CMD_NONE, (void *)write_data_start,
+				 desc->width * ST7789V_PIXEL_SIZE * desc->height);
+	} else if (config->cmd_data_gpio.port != NULL) {
+		st7789v_transmit_rows(dev, write_data_start, desc);
 	} else {
-		write_h = desc->height;
-		nbr_of_writes = 1U;
+		for (uint16_t row = 0U; row < desc->height; ++row) {
+			st7789v_transmit(dev, ST7789V_CMD_NONE, (void *)write_data_start,
+					 desc->width * ST7789V_PIXEL_SIZE);
+			write_data_start += (desc->pitch * ST7789V_PIXEL_SIZE);
+		}
 	}
+#endif /* CONFIG_ST7789V_RGB444 */
+
+	st7789v_stats_write_end(dev);
+	st7789v_bus_release(dev);
 
-	for (uint16_t write_cnt = 0U; write_cnt < nbr_of_writes; ++write_cnt) {
-		st7789v_transmit(dev, write_cnt == 0U ? ST7789V_CMD_RAMWR : ST7789V_CMD_NONE,
-				 (void *)write_data_start,
-				 desc->width * ST7789V_PIXEL_SIZE * write_h);
-		write_data_start += (desc->pitch * ST7789V_PIXEL_SIZE);
+#ifdef CONFIG_ST7789V_ASYNC_WRITE
+	if (data->write_done_cb != NULL) {
+		data->write_done_cb(dev, data->write_done_user_data);
 	}
+#endif
 
 	return 0;
 }
@@ -202,7 +998,7 @@ static void st7789v_get_capabilities(const struct device *dev,
 	capabilities->x_resolution = config->width;
 	capabilities->y_resolution = config->height;
 
-#ifdef CONFIG_ST7789V_RGB565
+#if defined(CONFIG_ST7789V_RGB565) || defined(CONFIG_ST7789V_RGB444)
 	capabilities->supported_pixel_formats = PIXEL_FORMAT_RGB_565;
 	capabilities->current_pixel_format = PIXEL_FORMAT_RGB_565;
 #else
@@ -215,7 +1011,7 @@ static void st7789v_get_capabilities(const struct device *dev,
 static int st7789v_set_pixel_format(const struct device *dev,
 				    const enum display_pixel_format pixel_format)
 {
-#ifdef CONFIG_ST7789V_RGB565
+#if defined(CONFIG_ST7789V_RGB565) || defined(CONFIG_ST7789V_RGB444)
 	if (pixel_format == PIXEL_FORMAT_RGB_565) {
 #else
 	if (pixel_format == PIXEL_FORMAT_RGB_888) {
@@ -233,30 +1029,25 @@ static int st7789v_set_orientation(const struct device *dev,
 	struct st7789v_data *data = dev->data;
 
 	/* only modifying the MY, MX, MV bits, keep existing MDAC config */
+	struct st7789v_batch batch = {0};
 	uint8_t tx_data = config->mdac & (ST7789V_MADCTL_ML | ST7789V_MADCTL_BGR |
 					  ST7789V_MADCTL_MH_RIGHT_TO_LEFT);
 
 	uint16_t x_offset = 0;
 	uint16_t y_offset = 0;
 
-	uint16_t row_offset = 0;
-	uint16_t col_offset = 0;
-
-	// if (config->width < 240) {
-		/* 135x240 display */
-		row_offset = data->y_offset;
-		col_offset = data->x_offset;
-	// } else {
-	// 	/* 240x320 and 240x240 displays */
-	// 	row_offset = (320 - config->height);
-	// 	col_offset = (240 - config->width);
-	// }
+	/*
+	 * Always derived from the devicetree offsets, the ones in data are
+	 * already swapped for the current orientation.
+	 */
+	uint16_t row_offset = config->y_offset;
+	uint16_t col_offset = config->x_offset;
 
 	switch (orientation) {
 	case DISPLAY_ORIENTATION_NORMAL:
 		tx_data |= ST7789V_MADCTL_MV_NORMAL_MODE;
-		x_offset = data->x_offset;
-		y_offset = data->y_offset;
+		x_offset = col_offset;
+		y_offset = row_offset;
 		break;
 
 	case DISPLAY_ORIENTATION_ROTATED_90:
@@ -273,8 +1064,8 @@ static int st7789v_set_orientation(const struct device *dev,
 
 	case DISPLAY_ORIENTATION_ROTATED_270:
 		tx_data |= (ST7789V_MADCTL_MX_RIGHT_TO_LEFT | ST7789V_MADCTL_MV_REVERSE_MODE);
-		x_offset = data->y_offset;
-		y_offset = data->x_offset;
+		x_offset = row_offset;
+		y_offset = col_offset;
 		break;
 
 	default:
@@ -282,88 +1073,197 @@ static int st7789v_set_orientation(const struct device *dev,
 		return -ENOTSUP;
 	}
 
+	st7789v_bus_acquire(dev);
 	st7789v_set_lcd_margins(dev, x_offset, y_offset);
-	st7789v_transmit(dev, ST7789V_CMD_MADCTL, &tx_data, 1U);
+	/* Resend the window, MV swaps how CASET and RASET are applied */
+	data->window_valid = false;
+	st7789v_batch_add(&batch, ST7789V_CMD_MADCTL, &tx_data, 1U);
+	st7789v_batch_flush(dev, &batch);
+	st7789v_bus_release(dev);
 	data->orientation = orientation;
 	LOG_INF("Changed orientation to: '%d'", data->orientation);
 
 	return 0;
 }
 
+/* Lines per frame including the back and front porch from PORCTRL */
+static uint32_t st7789v_frame_lines(const struct device *dev)
+{
+	const struct st7789v_config *config = dev->config;
+
+	return ST7789V_GRAM_ROWS + (config->porch_param[0] & 0x7f) +
+	       (config->porch_param[1] & 0x7f);
+}
+
+/* Frame rate = OSC / (lines * (250 + 16 * RTNA)), see FRCTRL2 in the datasheet */
+int st7789v_set_frame_rate(const struct device *dev, uint16_t hz)
+{
+	struct st7789v_data *data = dev->data;
+	struct st7789v_batch batch = {0};
+	uint32_t lines = st7789v_frame_lines(dev);
+	uint32_t clocks;
+	uint8_t rtna;
+
+	if (hz == 0) {
+		return -EINVAL;
+	}
+
+	clocks = ST7789V_OSC_HZ / (hz * lines);
+	if (clocks <= 250) {
+		rtna = 0;
+	} else {
+		rtna = MIN(DIV_ROUND_CLOSEST(clocks - 250, 16), ST7789V_FRCTRL2_RTNA_MAX);
+	}
+
+	st7789v_bus_acquire(dev);
+	data->frctrl2 = rtna & ST7789V_FRCTRL2_RTNA_MASK;
+	data->frame_period_us = (uint64_t)lines * (250 + 16 * rtna) * USEC_PER_SEC / ST7789V_OSC_HZ;
+	st7789v_batch_add(&batch, ST7789V_CMD_FRCTRL2, &data->frctrl2, 1);
+	st7789v_batch_flush(dev, &batch);
+	st7789v_bus_release(dev);
+
+	LOG_DBG("Frame rate %u Hz requested, period now %u us", hz, data->frame_period_us);
+
+	return 0;
+}
+
+int st7789v_set_partial_area(const struct device *dev, uint16_t x, uint16_t y, uint16_t w,
+			     uint16_t h)
+{
+	struct st7789v_batch batch = {0};
+	uint16_t first_line;
+	uint16_t last_line;
+	uint16_t ptlar[2];
+
+	st7789v_bus_acquire(dev);
+
+	if (w == 0 || h == 0) {
+		st7789v_batch_add(&batch, ST7789V_CMD_NORON, NULL, 0);
+	} else {
+		st7789v_scan_range(dev, x, y, w, h, &first_line, &last_line);
+		ptlar[0] = sys_cpu_to_be16(first_line);
+		ptlar[1] = sys_cpu_to_be16(last_line);
+		st7789v_batch_add(&batch, ST7789V_CMD_PTLAR, (uint8_t *)&ptlar[0], 4);
+		st7789v_batch_add(&batch, ST7789V_CMD_PTLON, NULL, 0);
+		LOG_DBG("Partial mode on lines %u-%u", first_line, last_line);
+	}
+
+	st7789v_batch_flush(dev, &batch);
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+
+int st7789v_set_idle_mode(const struct device *dev, bool enable)
+{
+	st7789v_bus_acquire(dev);
+	st7789v_transmit(dev, enable ? ST7789V_CMD_IDMON : ST7789V_CMD_IDMOFF, NULL, 0);
+	st7789v_bus_release(dev);
+
+	return 0;
+}
+
 static void st7789v_lcd_init(const struct device *dev)
 {
 	struct st7789v_data *data = dev->data;
 	const struct st7789v_config *config = dev->config;
-	uint8_t tmp;
+	struct st7789v_batch batch = {0};
+	uint8_t colmod;
+	/* Digital Gamma Enable, default disabled */
+	static const uint8_t dgmen = 0x00;
+	static const uint8_t vdvvrhen = 0x01;
+#if ST7789V_HAS_TE
+	static const uint8_t teon = ST7789V_TEON_VBLANK_ONLY;
+#endif
 
 	st7789v_set_lcd_margins(dev, data->x_offset, data->y_offset);
 
-	st7789v_transmit(dev, ST7789V_CMD_CMD2EN, (uint8_t *)config->cmd2en_param,
-			 sizeof(config->cmd2en_param));
+	/* A reset puts the address window back to the full panel */
+	data->window_valid = false;
 
-	st7789v_transmit(dev, ST7789V_CMD_PORCTRL, (uint8_t *)config->porch_param,
-			 sizeof(config->porch_param));
+	st7789v_batch_add(&batch, ST7789V_CMD_CMD2EN, config->cmd2en_param,
+			  sizeof(config->cmd2en_param));
 
-	/* Digital Gamma Enable, default disabled */
-	tmp = 0x00;
-	st7789v_transmit(dev, ST7789V_CMD_DGMEN, &tmp, 1);
+	st7789v_batch_add(&batch, ST7789V_CMD_PORCTRL, config->porch_param,
+			  sizeof(config->porch_param));
+
+	st7789v_batch_add(&batch, ST7789V_CMD_DGMEN, &dgmen, 1);
 
-	/* Frame Rate Control in Normal Mode, default value */
-	tmp = 0x0f;
-	st7789v_transmit(dev, ST7789V_CMD_FRCTRL2, &tmp, 1);
+	/* Frame Rate Control in Normal Mode, kept across re-initialisation */
+	st7789v_batch_add(&batch, ST7789V_CMD_FRCTRL2, &data->frctrl2, 1);
 
-	tmp = config->gctrl;
-	st7789v_transmit(dev, ST7789V_CMD_GCTRL, &tmp, 1);
+	st7789v_batch_add(&batch, ST7789V_CMD_GCTRL, &config->gctrl, 1);
 
-	tmp = config->vcom;
-	st7789v_transmit(dev, ST7789V_CMD_VCOMS, &tmp, 1);
+	st7789v_batch_add(&batch, ST7789V_CMD_VCOMS, &config->vcom, 1);
 
 	if (config->vdv_vrh_enable) {
-		tmp = 0x01;
-		st7789v_transmit(dev, ST7789V_CMD_VDVVRHEN, &tmp, 1);
+		st7789v_batch_add(&batch, ST7789V_CMD_VDVVRHEN, &vdvvrhen, 1);
 
-		tmp = config->vrh_value;
-		st7789v_transmit(dev, ST7789V_CMD_VRH, &tmp, 1);
+		st7789v_batch_add(&batch, ST7789V_CMD_VRH, &config->vrh_value, 1);
 
-		tmp = config->vdv_value;
-		st7789v_transmit(dev, ST7789V_CMD_VDS, &tmp, 1);
+		st7789v_batch_add(&batch, ST7789V_CMD_VDS, &config->vdv_value, 1);
 	}
 
-	st7789v_transmit(dev, ST7789V_CMD_PWCTRL1, (uint8_t *)config->pwctrl1_param,
-			 sizeof(config->pwctrl1_param));
+	st7789v_batch_add(&batch, ST7789V_CMD_PWCTRL1, config->pwctrl1_param,
+			  sizeof(config->pwctrl1_param));
 
 	/* Memory Data Access Control */
-	tmp = config->mdac;
-	st7789v_transmit(dev, ST7789V_CMD_MADCTL, &tmp, 1);
+	st7789v_batch_add(&batch, ST7789V_CMD_MADCTL, &config->mdac, 1);
 
 	/* Interface Pixel Format */
-	tmp = config->colmod;
-	st7789v_transmit(dev, ST7789V_CMD_COLMOD, &tmp, 1);
+#ifdef CONFIG_ST7789V_RGB444
+	colmod = (config->colmod & ~ST7789V_COLMOD_FMT_MASK) | ST7789V_COLMOD_FMT_12bit;
+#else
+	colmod = config->colmod;
+#endif
+	st7789v_batch_add(&batch, ST7789V_CMD_COLMOD, &colmod, 1);
 
-	tmp = config->lcm;
-	st7789v_transmit(dev, ST7789V_CMD_LCMCTRL, &tmp, 1);
+	st7789v_batch_add(&batch, ST7789V_CMD_LCMCTRL, &config->lcm, 1);
 
-	tmp = config->gamma;
-	st7789v_transmit(dev, ST7789V_CMD_GAMSET, &tmp, 1);
+	st7789v_batch_add(&batch, ST7789V_CMD_GAMSET, &config->gamma, 1);
 
-	st7789v_transmit(dev, ST7789V_CMD_INV_ON, NULL, 0);
+	st7789v_batch_add(&batch, ST7789V_CMD_INV_ON, NULL, 0);
 
-	st7789v_transmit(dev, ST7789V_CMD_PVGAMCTRL, (uint8_t *)config->pvgam_param,
-			 sizeof(config->pvgam_param));
+	st7789v_batch_add(&batch, ST7789V_CMD_PVGAMCTRL, config->pvgam_param,
+			  sizeof(config->pvgam_param));
 
-	st7789v_transmit(dev, ST7789V_CMD_NVGAMCTRL, (uint8_t *)config->nvgam_param,
-			 sizeof(config->nvgam_param));
+	st7789v_batch_add(&batch, ST7789V_CMD_NVGAMCTRL, config->nvgam_param,
+			  sizeof(config->nvgam_param));
 
-	st7789v_transmit(dev, ST7789V_CMD_RAMCTRL, (uint8_t *)config->ram_param,
-			 sizeof(config->ram_param));
+	st7789v_batch_add(&batch, ST7789V_CMD_RAMCTRL, config->ram_param,
+			  sizeof(config->ram_param));
 
-	st7789v_transmit(dev, ST7789V_CMD_RGBCTRL, (uint8_t *)config->rgb_param,
-			 sizeof(config->rgb_param));
+	st7789v_batch_add(&batch, ST7789V_CMD_RGBCTRL, config->rgb_param,
+			  sizeof(config->rgb_param));
+
+#if ST7789V_HAS_TE
+	if (data->te_gpio != NULL) {
+		st7789v_batch_add(&batch, ST7789V_CMD_TEON, &teon, 1);
+	}
+#endif
+
+	st7789v_batch_flush(dev, &batch);
 }
 
 static int st7789v_init(const struct device *dev)
 {
 	const struct st7789v_config *config = dev->config;
+	struct st7789v_data *data = dev->data;
+
+	data->batch_config = config->bus.config;
+	data->batch_config.operation |= SPI_HOLD_ON_CS | SPI_LOCK_ON;
+
+#if ST7789V_USES_9BIT
+	data->packed_config = config->bus.config;
+	data->packed_config.operation &= ~SPI_WORD_SIZE_MASK;
+	data->packed_config.operation |= SPI_WORD_SET(8);
+#endif
+
+	data->frame_period_us = ST7789V_DEFAULT_FRAME_PERIOD_US;
+
+#ifdef CONFIG_ST7789V_ASYNC_WRITE
+	k_sem_init(&data->bus_lock, 1, 1);
+#endif
 
 	if (!spi_is_ready_dt(&config->bus)) {
 		LOG_ERR("SPI device not ready");
@@ -394,6 +1294,14 @@ static int st7789v_init(const struct device *dev)
 		}
 	}
 
+#if ST7789V_HAS_TE
+	int ret = st7789v_te_init(dev);
+
+	if (ret < 0) {
+		return ret;
+	}
+#endif
+
 	st7789v_reset_display(dev);
 
 	st7789v_blanking_on(dev);
@@ -408,24 +1316,97 @@ static int st7789v_init(const struct device *dev)
 #ifdef CONFIG_PM_DEVICE
 static int st7789v_pm_action(const struct device *dev, enum pm_device_action action)
 {
+	struct st7789v_data *data = dev->data;
 	int ret = 0;
 
+	st7789v_bus_acquire(dev);
+
 	switch (action) {
 	case PM_DEVICE_ACTION_RESUME:
 		st7789v_exit_sleep(dev);
+		data->suspended = false;
 		break;
 	case PM_DEVICE_ACTION_SUSPEND:
 		st7789v_transmit(dev, ST7789V_CMD_SLEEP_IN, NULL, 0);
+		data->suspended = true;
 		break;
 	default:
 		ret = -ENOTSUP;
 		break;
 	}
 
+	st7789v_bus_release(dev);
+
 	return ret;
 }
 #endif /* CONFIG_PM_DEVICE */
 
+#if defined(CONFIG_ST7789V_STATS) && defined(CONFIG_SHELL)
+#define ST7789V_DEVICE(inst) DEVICE_DT_INST_GET(inst),
+
+static const struct device *const st7789v_devices[] = {
+	DT_INST_FOREACH_STATUS_OKAY(ST7789V_DEVICE)};
+
+static int cmd_st7789v_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(st7789v_devices); i++) {
+		const struct device *dev = st7789v_devices[i];
+		struct st7789v_window_stats window;
+		struct st7789v_stats stats;
+		int64_t elapsed_ms;
+
+		st7789v_get_stats(dev, &stats);
+		st7789v_get_window_stats(dev, &window);
+		elapsed_ms = MAX(k_uptime_get() - stats.reset_time, 1);
+
+		shell_print(sh, "%s: %u writes in %lld ms (%u.%02u/s)", dev->name, stats.writes,
+			    elapsed_ms, (uint32_t)(stats.writes * 1000LL / elapsed_ms),
+			    (uint32_t)(stats.writes * 100000LL / elapsed_ms % 100));
+		shell_print(sh, "  bus: %u transactions, %llu bytes, %llu us in SPI",
+			    stats.transactions, stats.bytes,
+			    k_cyc_to_us_floor64(stats.spi_cycles));
+		shell_print(sh, "  write: %llu us total, %u us max",
+			    k_cyc_to_us_floor64(stats.write_cycles),
+			    k_cyc_to_us_floor32(stats.max_write_cycles));
+		shell_print(sh, "  TE: %u waits, %u timeouts, %llu us waiting", stats.te_waits,
+			    stats.te_timeouts, k_cyc_to_us_floor64(stats.te_wait_cycles));
+		shell_print(sh, "  window: CASET %u sent %u elided, RASET %u sent %u elided",
+			    window.caset_sent, window.caset_elided, window.raset_sent,
+			    window.raset_elided);
+
+		for (uint8_t bucket = 0, limit = 6; bucket < ST7789V_STATS_AREA_BUCKETS;
+		     bucket++, limit += 2) {
+			if (bucket < ST7789V_STATS_AREA_BUCKETS - 1) {
+				shell_print(sh, "  area < %6u px: %u", BIT(limit),
+					    stats.area_hist[bucket]);
+			} else {
+				shell_print(sh, "  area >= %5u px: %u", BIT(limit - 2),
+					    stats.area_hist[bucket]);
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int cmd_st7789v_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(st7789v_devices); i++) {
+		st7789v_reset_stats(st7789v_devices[i]);
+	}
+
+	shell_print(sh, "Statistics reset");
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_st7789v,
+			       SHELL_CMD(stats, NULL, "Show transfer statistics", cmd_st7789v_stats),
+			       SHELL_CMD(reset, NULL, "Reset transfer statistics", cmd_st7789v_reset),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(st7789v, &sub_st7789v, "ST7789V display driver commands", NULL);
+#endif /* CONFIG_ST7789V_STATS && CONFIG_SHELL */
+
 static const struct display_driver_api st7789v_api = {
 	.blanking_on = st7789v_blanking_on,
 	.blanking_off = st7789v_blanking_off,
@@ -462,12 +1443,15 @@ static const struct display_driver_api st7789v_api = {
 		.rgb_param = DT_INST_PROP(inst, rgb_param),                                        \
 		.width = DT_INST_PROP(inst, width),                                                \
 		.height = DT_INST_PROP(inst, height),                                              \
+		.x_offset = DT_INST_PROP(inst, x_offset),                                          \
+		.y_offset = DT_INST_PROP(inst, y_offset),                                          \
 	};                                                                                         \
                                                                                                    \
 	static struct st7789v_data st7789v_data_##inst = {                                         \
 		.x_offset = DT_INST_PROP(inst, x_offset),                                          \
 		.y_offset = DT_INST_PROP(inst, y_offset),                                          \
 		.orientation = DISPLAY_ORIENTATION_NORMAL,                                         \
+		.frctrl2 = 0x0f,                                                                   \
 	};                                                                                         \
                                                                                                    \
 	PM_DEVICE_DT_INST_DEFINE(inst, st7789v_pm_action);                                         \
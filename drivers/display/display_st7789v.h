@@ -13,6 +13,8 @@
 
 #define ST7789V_CMD_SLEEP_IN			0x10
 #define ST7789V_CMD_SLEEP_OUT			0x11
+#define ST7789V_CMD_PTLON			0x12
+#define ST7789V_CMD_NORON			0x13
 #define ST7789V_CMD_INV_OFF			0x20
 #define ST7789V_CMD_INV_ON			0x21
 #define ST7789V_CMD_GAMSET			0x26
@@ -23,6 +25,12 @@
 #define ST7789V_CMD_RASET			0x2b
 #define ST7789V_CMD_RAMWR			0x2c
 
+#define ST7789V_CMD_PTLAR			0x30
+
+#define ST7789V_CMD_TEOFF			0x34
+#define ST7789V_CMD_TEON			0x35
+#define ST7789V_TEON_VBLANK_ONLY		0x00
+
 #define ST7789V_CMD_MADCTL			0x36
 #define ST7789V_MADCTL_MY_TOP_TO_BOTTOM		0x00
 #define ST7789V_MADCTL_MY_BOTTOM_TO_TOP		0x80
@@ -36,9 +44,13 @@
 #define ST7789V_MADCTL_MH_LEFT_TO_RIGHT		0x00
 #define ST7789V_MADCTL_MH_RIGHT_TO_LEFT		0x04
 
+#define ST7789V_CMD_IDMOFF			0x38
+#define ST7789V_CMD_IDMON			0x39
+
 #define ST7789V_CMD_COLMOD			0x3a
 #define ST7789V_COLMOD_RGB_65K			(0x5 << 4)
 #define ST7789V_COLMOD_RGB_262K			(0x6 << 4)
+#define ST7789V_COLMOD_FMT_MASK		(0x7)
 #define ST7789V_COLMOD_FMT_12bit		(3)
 #define ST7789V_COLMOD_FMT_16bit		(5)
 #define ST7789V_COLMOD_FMT_18bit		(6)
@@ -63,6 +75,8 @@
 #define ST7789V_CMD_VRH				0xc3
 #define ST7789V_CMD_VDS				0xc4
 #define ST7789V_CMD_FRCTRL2			0xc6
+#define ST7789V_FRCTRL2_RTNA_MASK		0x1f
+#define ST7789V_FRCTRL2_RTNA_MAX		0x1f
 #define ST7789V_CMD_PWCTRL1			0xd0
 
 #define ST7789V_CMD_PVGAMCTRL			0xe0
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "st7789v_pack.h"
+
+size_t st7789v_pack_9bit(uint8_t *out, const uint8_t *in, size_t count)
+{
+	size_t packed = count - (count % ST7789V_9BIT_GROUP_LEN);
+
+	for (size_t index = 0; index < packed; index += ST7789V_9BIT_GROUP_LEN) {
+		out[0] = 0x80 | (in[0] >> 1);
+		for (int k = 1; k < 8; k++) {
+			out[k] = (uint8_t)(in[k - 1] << (8 - k)) | (0x80 >> k) | (in[k] >> (k + 1));
+		}
+		out[8] = in[7];
+
+		in += ST7789V_9BIT_GROUP_LEN;
+		out += ST7789V_9BIT_GROUP_SIZE;
+	}
+
+	return packed;
+}
+
+void st7789v_pack_9bit_words(uint16_t *out, const uint8_t *in, size_t count)
+{
+	for (size_t index = 0; index < count; index++) {
+		out[index] = 0x0100 | in[index];
+	}
+}
+
+uint16_t st7789v_rgb565_to_rgb444(const uint8_t *in)
+{
+	uint16_t px = (uint16_t)(in[0] << 8) | in[1];
+
+	return ((px >> 4) & 0xf00) | ((px >> 3) & 0xf0) | ((px >> 1) & 0xf);
+}
+
+/* Converts pixel pairs of one row, both pixels of a pair in one 32-bit word */
+static void st7789v_pack_rgb444_pairs(uint8_t *out, const uint8_t *in, size_t pairs)
+{
+	for (size_t i = 0; i < pairs; i++) {
+		uint32_t px = ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) |
+			      ((uint32_t)in[2] << 8) | in[3];
+		uint32_t nibbles = ((px >> 4) & 0x0f000f00) | ((px >> 3) & 0x00f000f0) |
+				   ((px >> 1) & 0x000f000f);
+		uint32_t packed = ((nibbles >> 4) & 0xfff000) | (nibbles & 0xfff);
+
+		out[0] = (uint8_t)(packed >> 16);
+		out[1] = (uint8_t)(packed >> 8);
+		out[2] = (uint8_t)packed;
+		in += 4;
+		out += 3;
+	}
+}
+
+size_t st7789v_pack_rgb444(struct st7789v_rgb444_area *area, uint8_t *out, size_t size)
+{
+	size_t used = 0;
+
+	while (area->row < area->height && used + 3 <= size) {
+		const uint8_t *in = area->buf + ((size_t)area->row * area->pitch + area->col) * 2;
+		uint16_t left = area->width - area->col;
+
+		if (left >= 2) {
+			size_t pairs = (size - used) / 3;
+
+			if (pairs > left / 2) {
+				pairs = left / 2;
+			}
+
+			st7789v_pack_rgb444_pairs(&out[used], in, pairs);
+			used += pairs * 3;
+			area->col += pairs * 2;
+		} else {
+			uint16_t first = st7789v_rgb565_to_rgb444(in);
+
+			area->row++;
+			area->col = 0;
+
+			if (area->row < area->height) {
+				uint16_t second = st7789v_rgb565_to_rgb444(
+					area->buf + (size_t)area->row * area->pitch * 2);
+
+				out[used] = (uint8_t)(first >> 4);
+				out[used + 1] = (uint8_t)(first << 4) | (uint8_t)(second >> 8);
+				out[used + 2] = (uint8_t)second;
+				used += 3;
+				area->col = 1;
+			} else {
+				out[used] = (uint8_t)(first >> 4);
+				out[used + 1] = (uint8_t)(first << 4);
+				used += 2;
+			}
+		}
+
+		if (area->col == area->width) {
+			area->row++;
+			area->col = 0;
+		}
+	}
+
+	return used;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2024 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Pixel data packing for the ST7789V wire formats. Plain C without Zephyr
+ * dependencies, so it can be tested on the host.
+ */
+
+#ifndef ST7789V_PACK_H__
+#define ST7789V_PACK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Data bytes in a group of 9-bit words that packs into whole bytes */
+#define ST7789V_9BIT_GROUP_LEN 8
+/* Packed size of such a group */
+#define ST7789V_9BIT_GROUP_SIZE 9
+
+/*
+ * Packs the whole groups of 8 data bytes at the start of in into the MSB
+ * first bitstream of 9-bit words with the D/C bit set, so they can be sent
+ * with 8-bit SPI words. Returns the number of data bytes packed, a trailing
+ * partial group is left for st7789v_pack_9bit_words().
+ */
+size_t st7789v_pack_9bit(uint8_t *out, const uint8_t *in, size_t count);
+
+/* Expands data bytes into 9-bit SPI words with the D/C bit set */
+void st7789v_pack_9bit_words(uint16_t *out, const uint8_t *in, size_t count);
+
+/* Smallest output buffer st7789v_pack_rgb444() makes progress with */
+#define ST7789V_RGB444_MIN_OUT 3
+
+/* Big endian RGB565 area being converted to the RGB444 wire format */
+struct st7789v_rgb444_area {
+	const uint8_t *buf;
+	uint16_t width;
+	uint16_t height;
+	/* Row stride in pixels */
+	uint16_t pitch;
+	/* Position of the next pixel to convert */
+	uint16_t row;
+	uint16_t col;
+};
+
+/* Converts one big endian RGB565 pixel, keeping the top nibble of each channel */
+uint16_t st7789v_rgb565_to_rgb444(const uint8_t *in);
+
+/*
+ * Packs the next pixels of an area into out, two pixels per 3 bytes, and
+ * returns the number of bytes written, 0 once the area is complete. Pixel
+ * pairs straddle rows when the width is odd. A trailing single pixel is
+ * written as two bytes, its unused nibble is dropped by the panel at the end
+ * of the window.
+ */
+size_t st7789v_pack_rgb444(struct st7789v_rgb444_area *area, uint8_t *out, size_t size);
+
+#endif /* ST7789V_PACK_H__ */
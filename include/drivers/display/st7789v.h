@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2024 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief Extended API of the Sitronix ST7789V display driver.
+ */
+
+#ifndef ZMK_DRIVERS_DISPLAY_ST7789V_H_
+#define ZMK_DRIVERS_DISPLAY_ST7789V_H_
+
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Called when the pixel data of a display_write() has left the bus.
+ *
+ * May be called from interrupt context.
+ */
+typedef void (*st7789v_write_done_cb_t)(const struct device *dev, void *user_data);
+
+/**
+ * @brief Register a write completion callback.
+ *
+ * With CONFIG_ST7789V_ASYNC_WRITE enabled and a callback registered,
+ * display_write() returns as soon as the transfer has been started and the
+ * callback is invoked once it has completed. Every write that returns 0 is
+ * followed by exactly one callback, including writes the driver had to
+ * complete synchronously. The caller must keep the pixel buffer untouched
+ * until then. Passing NULL restores fully synchronous writes.
+ *
+ * @param dev ST7789V device.
+ * @param cb Completion callback, or NULL.
+ * @param user_data Opaque pointer passed to @p cb.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if asynchronous writes are not enabled.
+ */
+int st7789v_set_write_done_cb(const struct device *dev, st7789v_write_done_cb_t cb,
+			      void *user_data);
+
+/** @brief Address window commands sent and skipped because nothing changed. */
+struct st7789v_window_stats {
+	uint32_t caset_sent;
+	uint32_t caset_elided;
+	uint32_t raset_sent;
+	uint32_t raset_elided;
+};
+
+/**
+ * @brief Get the CASET/RASET counters since boot or the last st7789v_reset_stats().
+ *
+ * @param dev ST7789V device.
+ * @param stats Filled with the current counters.
+ *
+ * @retval 0 on success.
+ */
+int st7789v_get_window_stats(const struct device *dev, struct st7789v_window_stats *stats);
+
+/**
+ * @brief Get the address window last sent to the panel.
+ *
+ * The window is in controller RAM coordinates, display offsets included, as
+ * programmed with CASET and RASET.
+ *
+ * @param dev ST7789V device.
+ * @param window Filled with the first and last column, then the first and
+ *               last row.
+ *
+ * @retval 0 on success.
+ * @retval -ENODATA if no window was sent since init or the last orientation
+ *         change.
+ */
+int st7789v_get_window(const struct device *dev, uint16_t window[4]);
+
+/**
+ * @brief Change the panel's internal refresh rate.
+ *
+ * Picks the FRCTRL2 setting closest to @p hz for the configured porches. The
+ * panel supports roughly 39 to 119 Hz, requests outside are clamped.
+ *
+ * @param dev ST7789V device.
+ * @param hz Requested frame rate in Hz.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if @p hz is 0.
+ */
+int st7789v_set_frame_rate(const struct device *dev, uint16_t hz);
+
+/**
+ * @brief Restrict panel scanning to the gate lines covering an area.
+ *
+ * Enters partial mode with the smallest PTLAR range that covers the given
+ * area in display coordinates, taking the current orientation into account.
+ * Lines outside of it are not refreshed. An empty area returns to normal mode.
+ *
+ * @param dev ST7789V device.
+ * @param x Area start column.
+ * @param y Area start row.
+ * @param w Area width, 0 for normal mode.
+ * @param h Area height, 0 for normal mode.
+ *
+ * @retval 0 on success.
+ */
+int st7789v_set_partial_area(const struct device *dev, uint16_t x, uint16_t y, uint16_t w,
+			     uint16_t h);
+
+/**
+ * @brief Switch idle mode, which drops the panel to 8 colours.
+ *
+ * @param dev ST7789V device.
+ * @param enable True to enter idle mode, false to leave it.
+ *
+ * @retval 0 on success.
+ */
+int st7789v_set_idle_mode(const struct device *dev, bool enable);
+
+/**
+ * @brief Mark the start of a new frame for tearing effect synchronization.
+ *
+ * With a TE line configured, the next display_write() first waits for the
+ * panel's vertical blanking edge. Later writes go out immediately until this
+ * is called again, so a frame flushed in several strips only waits once. The
+ * wait is skipped while the panel is blanked or suspended, and a missing edge
+ * only delays the write by two frame periods.
+ *
+ * @param dev ST7789V device.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if no TE line is configured for @p dev.
+ */
+int st7789v_frame_begin(const struct device *dev);
+
+/** Number of buckets in the write area histogram. */
+#define ST7789V_STATS_AREA_BUCKETS 7
+
+/** @brief Transfer statistics collected with CONFIG_ST7789V_STATS. */
+struct st7789v_stats {
+	/** display_write() calls */
+	uint32_t writes;
+	/** Pixels written */
+	uint64_t pixels;
+	/** SPI transactions, commands included */
+	uint32_t transactions;
+	/** Bytes put on the bus, commands included */
+	uint64_t bytes;
+	/** Cycles spent in SPI transfers, asynchronous ones until completion */
+	uint64_t spi_cycles;
+	/**
+	 * Cycles spent in display_write(), TE waits excluded. Asynchronous
+	 * writes count until the transfer completes.
+	 */
+	uint64_t write_cycles;
+	uint32_t max_write_cycles;
+	/** Frames that waited for TE and the ones that timed out */
+	uint32_t te_waits;
+	uint32_t te_timeouts;
+	/** Cycles spent waiting for TE */
+	uint64_t te_wait_cycles;
+	/** Write areas by pixel count: < 64, < 256, ... < 65536, >= 65536 */
+	uint32_t area_hist[ST7789V_STATS_AREA_BUCKETS];
+	/** Uptime in ms when the statistics were last reset */
+	int64_t reset_time;
+	/** Internal, start of the write being measured */
+	uint32_t write_start;
+};
+
+/**
+ * @brief Get the transfer statistics.
+ *
+ * @param dev ST7789V device.
+ * @param stats Filled with the current statistics.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if CONFIG_ST7789V_STATS is disabled.
+ */
+int st7789v_get_stats(const struct device *dev, struct st7789v_stats *stats);
+
+/**
+ * @brief Reset the transfer and address window statistics.
+ *
+ * @param dev ST7789V device.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if CONFIG_ST7789V_STATS is disabled.
+ */
+int st7789v_reset_stats(const struct device *dev);
+
+/**
+ * @brief Start a CRC-32 over all pixel data written from now on.
+ *
+ * Pixels are hashed as passed to display_write(), row by row in write order,
+ * so the result identifies the rendered content independent of the transfer
+ * mode. Requires CONFIG_ST7789V_STATS.
+ *
+ * @param dev ST7789V device.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if CONFIG_ST7789V_STATS is disabled.
+ */
+int st7789v_crc_start(const struct device *dev);
+
+/**
+ * @brief Stop the pixel CRC started with st7789v_crc_start().
+ *
+ * @param dev ST7789V device.
+ * @param crc Filled with the CRC-32 of the pixels written in between.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if CONFIG_ST7789V_STATS is disabled.
+ */
+int st7789v_crc_stop(const struct device *dev, uint32_t *crc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZMK_DRIVERS_DISPLAY_ST7789V_H_ */
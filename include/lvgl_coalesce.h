@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2024 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ZMK_MODULES_LVGL_COALESCE_H_
+#define ZMK_MODULES_LVGL_COALESCE_H_
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Dirty area coalescing counters since boot. */
+struct lvgl_coalesce_stats {
+	/** Refreshes that had at least one dirty area */
+	uint32_t frames;
+	/** Dirty areas LVGL invalidated, layout changes included */
+	uint32_t areas_in;
+	/** Areas left after coalescing */
+	uint32_t areas_out;
+	/** Pixels rendered and sent only because areas were merged */
+	uint64_t extra_pixels;
+};
+
+/**
+ * @brief Get the dirty area coalescing counters.
+ *
+ * @param stats Filled with the current counters.
+ */
+void lvgl_coalesce_get_stats(struct lvgl_coalesce_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZMK_MODULES_LVGL_COALESCE_H_ */
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2024 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ZMK_MODULES_LVGL_MEMORY_H_
+#define ZMK_MODULES_LVGL_MEMORY_H_
+
+#include <stdbool.h>
+#include <zephyr/sys/mem_stats.h>
+#include <zephyr/sys/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the usage of the LVGL heap.
+ *
+ * Requires CONFIG_SYS_HEAP_RUNTIME_STATS.
+ *
+ * @param stats Filled with the allocated, free and peak allocated bytes.
+ *
+ * @retval 0 on success.
+ */
+int lvgl_heap_get_stats(struct sys_memory_stats *stats);
+
+/** @brief LVGL heap usage charged to one widget or subsystem. */
+struct lvgl_mem_account {
+	const char *name;
+	/** Allocations made under the account */
+	uint32_t allocs;
+	/** Allocations of the account freed, whichever scope freed them */
+	uint32_t frees;
+	/** Bytes currently allocated */
+	size_t bytes;
+	/** Highest value of bytes seen */
+	size_t peak;
+	/** Internal */
+	sys_snode_t node;
+	bool registered;
+};
+
+/** Define an account named after @p _name. */
+#define LVGL_MEM_ACCOUNT_DEFINE(_name) struct lvgl_mem_account _name = {.name = #_name}
+
+#ifdef CONFIG_LV_Z_MEM_ACCOUNTING
+
+/**
+ * @brief Charge LVGL allocations of the calling code to an account.
+ *
+ * Scopes nest, LVGL is only used from one thread so the current account is
+ * global. Allocations outside of any scope are charged to "other".
+ *
+ * @param account Account to charge from now on.
+ *
+ * @return The previous account, to pass to lvgl_mem_account_exit().
+ */
+struct lvgl_mem_account *lvgl_mem_account_enter(struct lvgl_mem_account *account);
+
+/**
+ * @brief Return to the account that was current before lvgl_mem_account_enter().
+ *
+ * @param previous Value returned by the matching lvgl_mem_account_enter().
+ */
+void lvgl_mem_account_exit(struct lvgl_mem_account *previous);
+
+/**
+ * @brief Call @p cb for every account used so far.
+ */
+void lvgl_mem_account_foreach(void (*cb)(const struct lvgl_mem_account *account, void *user_data),
+			      void *user_data);
+
+/**
+ * @brief Clear allocation counts and restart peaks from the current usage.
+ */
+void lvgl_mem_account_reset(void);
+
+#define LVGL_MEM_ACCOUNT_ENTER(_account)                                                           \
+	struct lvgl_mem_account *_lvgl_mem_previous = lvgl_mem_account_enter(&(_account))
+#define LVGL_MEM_ACCOUNT_EXIT() lvgl_mem_account_exit(_lvgl_mem_previous)
+
+#else
+
+#define LVGL_MEM_ACCOUNT_ENTER(_account) ARG_UNUSED(_account)
+#define LVGL_MEM_ACCOUNT_EXIT()
+
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZMK_MODULES_LVGL_MEMORY_H_ */
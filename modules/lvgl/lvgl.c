@@ -16,6 +16,15 @@
 #include "lvgl_mem.h"
 #endif
 #include LV_MEM_CUSTOM_INCLUDE
+/* Writes are paced by the panel's tearing effect output */
+#define LVGL_TE_SYNC DT_HAS_COMPAT_STATUS_OKAY(zmk_st7789v_te)
+
+#if defined(CONFIG_ST7789V_ASYNC_WRITE) || LVGL_TE_SYNC
+#include <drivers/display/st7789v.h>
+#endif
+#ifdef CONFIG_LV_Z_COALESCE_AREAS
+#include <lvgl_coalesce.h>
+#endif
 
 #define LOG_LEVEL CONFIG_LV_LOG_LEVEL
 #include <zephyr/logging/log.h>
@@ -95,6 +104,167 @@ static void lvgl_log(const char *buf)
 }
 #endif
 
+#ifdef CONFIG_ST7789V_ASYNC_WRITE
+/*
+ * The ST7789V driver returns from display_write() as soon as the pixel data is
+ * on its way, so the flush is only reported as done from the SPI completion.
+ * With a double VDB this lets LVGL render into the other buffer meanwhile.
+ * When LVGL has to wait for a buffer it sleeps on flush_done_sem instead of
+ * spinning, leaving the CPU to other threads until the transfer completes.
+ */
+static K_SEM_DEFINE(flush_done_sem, 0, 1);
+
+static void lvgl_flush_done_async(const struct device *dev, void *user_data)
+{
+	ARG_UNUSED(dev);
+
+	lv_disp_flush_ready((lv_disp_drv_t *)user_data);
+	k_sem_give(&flush_done_sem);
+}
+
+static void lvgl_flush_wait_cb(lv_disp_drv_t *disp_drv)
+{
+	ARG_UNUSED(disp_drv);
+
+	/* Bounded, a give from an earlier flush only costs one more check */
+	k_sem_take(&flush_done_sem, K_MSEC(10));
+}
+
+static void lvgl_flush_cb_async(lv_disp_drv_t *disp_drv, const lv_area_t *area,
+				lv_color_t *color_p)
+{
+	struct lvgl_disp_data *data = (struct lvgl_disp_data *)disp_drv->user_data;
+	uint16_t w = area->x2 - area->x1 + 1;
+	uint16_t h = area->y2 - area->y1 + 1;
+	struct display_buffer_descriptor desc;
+
+	desc.buf_size = w * 2U * h;
+	desc.width = w;
+	desc.pitch = w;
+	desc.height = h;
+
+	if (display_write(data->display_dev, area->x1, area->y1, &desc, (void *)color_p) != 0) {
+		lv_disp_flush_ready(disp_drv);
+	}
+}
+
+static void lvgl_setup_async_flush(lv_disp_drv_t *disp_driver)
+{
+	struct lvgl_disp_data *data = (struct lvgl_disp_data *)disp_driver->user_data;
+
+	if (data->cap.current_pixel_format != PIXEL_FORMAT_RGB_565) {
+		return;
+	}
+
+	if (st7789v_set_write_done_cb(data->display_dev, lvgl_flush_done_async, disp_driver) !=
+	    0) {
+		LOG_WRN("Async flush not available, using synchronous writes");
+		return;
+	}
+
+	disp_driver->flush_cb = lvgl_flush_cb_async;
+	disp_driver->wait_cb = lvgl_flush_wait_cb;
+}
+#endif /* CONFIG_ST7789V_ASYNC_WRITE */
+
+#ifdef CONFIG_LV_Z_COALESCE_AREAS
+static struct lvgl_coalesce_stats coalesce_stats;
+
+void lvgl_coalesce_get_stats(struct lvgl_coalesce_stats *stats)
+{
+	*stats = coalesce_stats;
+}
+
+/*
+ * Merges pairs of dirty areas into their bounding box whenever the pixels
+ * this adds cost fewer bus bytes than the window commands and transaction
+ * overhead of a separate flush, as configured by LV_Z_COALESCE_FLUSH_COST.
+ * Merged away areas are marked joined, which LVGL's own joining respects.
+ */
+static void lvgl_coalesce_areas(lv_disp_t *disp)
+{
+	bool merged;
+
+	do {
+		merged = false;
+
+		for (uint16_t i = 0; i < disp->inv_p; i++) {
+			if (disp->inv_area_joined[i]) {
+				continue;
+			}
+
+			for (uint16_t j = i + 1; j < disp->inv_p; j++) {
+				lv_area_t joined;
+				int32_t extra;
+
+				if (disp->inv_area_joined[j]) {
+					continue;
+				}
+
+				_lv_area_join(&joined, &disp->inv_areas[i], &disp->inv_areas[j]);
+				extra = (int32_t)lv_area_get_size(&joined) -
+					(int32_t)lv_area_get_size(&disp->inv_areas[i]) -
+					(int32_t)lv_area_get_size(&disp->inv_areas[j]);
+
+				if (extra * (int32_t)sizeof(lv_color_t) <
+				    CONFIG_LV_Z_COALESCE_FLUSH_COST) {
+					lv_area_copy(&disp->inv_areas[i], &joined);
+					disp->inv_area_joined[j] = 1;
+					coalesce_stats.extra_pixels += MAX(extra, 0);
+					merged = true;
+				}
+			}
+		}
+	} while (merged);
+}
+
+#endif /* CONFIG_LV_Z_COALESCE_AREAS */
+
+#if defined(CONFIG_LV_Z_COALESCE_AREAS) || LVGL_TE_SYNC
+static void lvgl_refr_timer_cb(lv_timer_t *timer)
+{
+	lv_disp_t *disp = timer->user_data;
+
+#ifdef CONFIG_LV_Z_COALESCE_AREAS
+	/*
+	 * Run the layout pass _lv_disp_refr_timer() starts with first, so the
+	 * areas it invalidates are joined and counted too. Repeating it there
+	 * finds nothing left to do.
+	 */
+	if (disp->act_scr != NULL) {
+		lv_obj_update_layout(disp->act_scr);
+		if (disp->prev_scr != NULL) {
+			lv_obj_update_layout(disp->prev_scr);
+		}
+		lv_obj_update_layout(disp->top_layer);
+		lv_obj_update_layout(disp->sys_layer);
+	}
+
+	if (disp->inv_p > 0 && !disp->driver->full_refresh) {
+		coalesce_stats.frames++;
+		coalesce_stats.areas_in += disp->inv_p;
+
+		lvgl_coalesce_areas(disp);
+
+		for (uint16_t i = 0; i < disp->inv_p; i++) {
+			coalesce_stats.areas_out += disp->inv_area_joined[i] ? 0 : 1;
+		}
+	}
+#endif
+
+#if LVGL_TE_SYNC
+	/*
+	 * Only the first flush of a refresh waits for vertical blanking, the
+	 * remaining strips follow back to back. Left armed when nothing is
+	 * drawn, the next flush is the first of a frame either way.
+	 */
+	st7789v_frame_begin(((struct lvgl_disp_data *)disp->driver->user_data)->display_dev);
+#endif
+
+	_lv_disp_refr_timer(timer);
+}
+#endif
+
 #ifdef CONFIG_LV_Z_BUFFER_ALLOC_STATIC
 
 static int lvgl_allocate_rendering_buffers(lv_disp_drv_t *disp_driver)
@@ -195,6 +365,7 @@ static int lvgl_allocate_rendering_buffers(lv_disp_drv_t *disp_driver)
 static int lvgl_init(void)
 {
 	const struct device *display_dev = DEVICE_DT_GET(DISPLAY_NODE);
+	lv_disp_t *disp;
 
 	int err = 0;
 
@@ -255,11 +426,24 @@ static int lvgl_init(void)
 		return -ENOTSUP;
 	}
 
-	if (lv_disp_drv_register(&disp_drv) == NULL) {
+#ifdef CONFIG_ST7789V_ASYNC_WRITE
+	lvgl_setup_async_flush(&disp_drv);
+#endif
+
+	disp = lv_disp_drv_register(&disp_drv);
+	if (disp == NULL) {
 		LOG_ERR("Failed to register display device.");
 		return -EPERM;
 	}
 
+	LOG_INF("Rendering %dx%d, rotated %d degrees by the %s", lv_disp_get_hor_res(disp),
+		lv_disp_get_ver_res(disp), disp_drv.rotated * 90,
+		disp_drv.sw_rotate ? "LVGL" : "display controller");
+
+#if defined(CONFIG_LV_Z_COALESCE_AREAS) || LVGL_TE_SYNC
+	lv_timer_set_cb(disp->refr_timer, lvgl_refr_timer_cb);
+#endif
+
 	err = lvgl_init_input_devices();
 	if (err < 0) {
 		LOG_ERR("Failed to initialize input devices.");
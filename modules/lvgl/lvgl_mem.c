@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2020 Teslabs Engineering S.L.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "lvgl_mem.h"
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/sys_heap.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/shell/shell.h>
+#include <lvgl_memory.h>
+
+#ifdef CONFIG_LV_Z_MEMORY_POOL_CUSTOM_SECTION
+#define HEAP_MEM_ATTRIBUTES Z_GENERIC_SECTION(.lvgl_heap) __aligned(8)
+#else
+#define HEAP_MEM_ATTRIBUTES __aligned(8)
+#endif /* CONFIG_LV_Z_MEMORY_POOL_CUSTOM_SECTION */
+static char lvgl_heap_mem[CONFIG_LV_Z_MEM_POOL_SIZE] HEAP_MEM_ATTRIBUTES;
+static struct sys_heap lvgl_heap;
+static struct k_spinlock lvgl_heap_lock;
+
+#ifdef CONFIG_LV_Z_MEM_ACCOUNTING
+/*
+ * Every allocation is prefixed with the account it was made under and its
+ * requested size, so frees and reallocs are charged to the right account
+ * no matter which scope they happen in.
+ */
+struct lvgl_mem_header {
+	struct lvgl_mem_account *account;
+	size_t size;
+} __aligned(8);
+
+static LVGL_MEM_ACCOUNT_DEFINE(other);
+static struct lvgl_mem_account *current_account = &other;
+static sys_slist_t accounts = SYS_SLIST_STATIC_INIT(&accounts);
+
+static void lvgl_mem_account_register(struct lvgl_mem_account *account)
+{
+	if (!account->registered) {
+		account->registered = true;
+		sys_slist_append(&accounts, &account->node);
+	}
+}
+
+static void lvgl_mem_charge(struct lvgl_mem_account *account, size_t size)
+{
+	account->allocs++;
+	account->bytes += size;
+	account->peak = MAX(account->peak, account->bytes);
+}
+
+static void lvgl_mem_credit(struct lvgl_mem_account *account, size_t size)
+{
+	account->frees++;
+	account->bytes -= size;
+}
+
+struct lvgl_mem_account *lvgl_mem_account_enter(struct lvgl_mem_account *account)
+{
+	struct lvgl_mem_account *previous = current_account;
+
+	lvgl_mem_account_register(account);
+	current_account = account;
+
+	return previous;
+}
+
+void lvgl_mem_account_exit(struct lvgl_mem_account *previous)
+{
+	current_account = previous;
+}
+
+void lvgl_mem_account_foreach(void (*cb)(const struct lvgl_mem_account *account, void *user_data),
+			      void *user_data)
+{
+	struct lvgl_mem_account *account;
+
+	lvgl_mem_account_register(&other);
+	SYS_SLIST_FOR_EACH_CONTAINER(&accounts, account, node) {
+		cb(account, user_data);
+	}
+}
+
+void lvgl_mem_account_reset(void)
+{
+	struct lvgl_mem_account *account;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lvgl_heap_lock);
+	SYS_SLIST_FOR_EACH_CONTAINER(&accounts, account, node) {
+		account->allocs = 0;
+		account->frees = 0;
+		account->peak = account->bytes;
+	}
+	k_spin_unlock(&lvgl_heap_lock, key);
+}
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING */
+
+void *lvgl_malloc(size_t size)
+{
+	k_spinlock_key_t key;
+	void *ret;
+
+	key = k_spin_lock(&lvgl_heap_lock);
+#ifdef CONFIG_LV_Z_MEM_ACCOUNTING
+	struct lvgl_mem_header *header =
+		sys_heap_alloc(&lvgl_heap, sizeof(struct lvgl_mem_header) + size);
+
+	ret = NULL;
+	if (header != NULL) {
+		header->account = current_account;
+		header->size = size;
+		lvgl_mem_charge(header->account, size);
+		ret = header + 1;
+	}
+#else
+	ret = sys_heap_alloc(&lvgl_heap, size);
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING */
+	k_spin_unlock(&lvgl_heap_lock, key);
+
+	return ret;
+}
+
+void *lvgl_realloc(void *ptr, size_t size)
+{
+	k_spinlock_key_t key;
+	void *ret;
+
+#ifdef CONFIG_LV_Z_MEM_ACCOUNTING
+	if (ptr == NULL) {
+		return lvgl_malloc(size);
+	}
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING */
+
+	key = k_spin_lock(&lvgl_heap_lock);
+#ifdef CONFIG_LV_Z_MEM_ACCOUNTING
+	struct lvgl_mem_header *header = (struct lvgl_mem_header *)ptr - 1;
+	struct lvgl_mem_account *account = header->account;
+	size_t old_size = header->size;
+
+	header = sys_heap_realloc(&lvgl_heap, header, sizeof(struct lvgl_mem_header) + size);
+
+	ret = NULL;
+	if (header != NULL) {
+		header->size = size;
+		account->bytes -= old_size;
+		account->bytes += size;
+		account->peak = MAX(account->peak, account->bytes);
+		ret = header + 1;
+	}
+#else
+	ret = sys_heap_realloc(&lvgl_heap, ptr, size);
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING */
+	k_spin_unlock(&lvgl_heap_lock, key);
+
+	return ret;
+}
+
+void lvgl_free(void *ptr)
+{
+	k_spinlock_key_t key;
+
+#ifdef CONFIG_LV_Z_MEM_ACCOUNTING
+	if (ptr == NULL) {
+		return;
+	}
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING */
+
+	key = k_spin_lock(&lvgl_heap_lock);
+#ifdef CONFIG_LV_Z_MEM_ACCOUNTING
+	struct lvgl_mem_header *header = (struct lvgl_mem_header *)ptr - 1;
+
+	lvgl_mem_credit(header->account, header->size);
+	sys_heap_free(&lvgl_heap, header);
+#else
+	sys_heap_free(&lvgl_heap, ptr);
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING */
+	k_spin_unlock(&lvgl_heap_lock, key);
+}
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+int lvgl_heap_get_stats(struct sys_memory_stats *stats)
+{
+	k_spinlock_key_t key;
+	int ret;
+
+	key = k_spin_lock(&lvgl_heap_lock);
+	ret = sys_heap_runtime_stats_get(&lvgl_heap, stats);
+	k_spin_unlock(&lvgl_heap_lock, key);
+
+	return ret;
+}
+#endif /* CONFIG_SYS_HEAP_RUNTIME_STATS */
+
+void lvgl_print_heap_info(bool dump_chunks)
+{
+	k_spinlock_key_t key;
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	struct sys_memory_stats stats;
+
+	if (lvgl_heap_get_stats(&stats) == 0) {
+		printk("LVGL heap: %zu bytes at %p, %zu allocated, %zu peak, %zu free\n",
+		       sizeof(lvgl_heap_mem), (void *)lvgl_heap_mem, stats.allocated_bytes,
+		       stats.max_allocated_bytes, stats.free_bytes);
+	}
+#endif /* CONFIG_SYS_HEAP_RUNTIME_STATS */
+
+	key = k_spin_lock(&lvgl_heap_lock);
+	sys_heap_print_info(&lvgl_heap, dump_chunks);
+	k_spin_unlock(&lvgl_heap_lock, key);
+}
+
+void lvgl_heap_init(void)
+{
+	sys_heap_init(&lvgl_heap, &lvgl_heap_mem[0], CONFIG_LV_Z_MEM_POOL_SIZE);
+}
+
+#if defined(CONFIG_LV_Z_MEM_ACCOUNTING) && defined(CONFIG_SHELL)
+static void lvgl_mem_print_account(const struct lvgl_mem_account *account, void *user_data)
+{
+	const struct shell *sh = user_data;
+
+	shell_print(sh, "%-20s %7u %7u %7zu %7zu", account->name, account->allocs, account->frees,
+		    account->bytes, account->peak);
+}
+
+static int cmd_lvgl_mem(const struct shell *sh, size_t argc, char **argv)
+{
+	shell_print(sh, "%-20s %7s %7s %7s %7s", "account", "allocs", "frees", "bytes", "peak");
+	lvgl_mem_account_foreach(lvgl_mem_print_account, (void *)sh);
+
+	return 0;
+}
+
+static int cmd_lvgl_mem_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	lvgl_mem_account_reset();
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_lvgl_mem,
+			       SHELL_CMD(reset, NULL,
+					 "Clear allocation counts and restart peaks from current usage",
+					 cmd_lvgl_mem_reset),
+			       SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(lvgl_mem, &sub_lvgl_mem, "Show LVGL heap usage per account", cmd_lvgl_mem);
+#endif /* CONFIG_LV_Z_MEM_ACCOUNTING && CONFIG_SHELL */
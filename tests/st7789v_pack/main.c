@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2024 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "st7789v_pack.h"
+
+static int failures;
+
+#define CHECK(cond, ...)                                                                           \
+	do {                                                                                       \
+		if (!(cond)) {                                                                     \
+			printf("FAIL %s:%d: ", __func__, __LINE__);                                \
+			printf(__VA_ARGS__);                                                       \
+			printf("\n");                                                              \
+			failures++;                                                                \
+		}                                                                                  \
+	} while (0)
+
+static void fill_pattern(uint8_t *buf, size_t len, uint8_t seed)
+{
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = (uint8_t)(seed + i * 37);
+	}
+}
+
+/* Reads the 9-bit word at index from an MSB first bitstream */
+static uint16_t read_9bit(const uint8_t *stream, size_t index)
+{
+	uint16_t word = 0;
+
+	for (size_t bit = index * 9; bit < index * 9 + 9; bit++) {
+		word = (word << 1) | ((stream[bit / 8] >> (7 - bit % 8)) & 1);
+	}
+
+	return word;
+}
+
+static void test_9bit_groups(size_t count, uint8_t seed)
+{
+	uint8_t in[512];
+	uint8_t out[512 / 8 * 9 + 1];
+	size_t packed;
+
+	fill_pattern(in, count, seed);
+	memset(out, 0xa5, sizeof(out));
+
+	packed = st7789v_pack_9bit(out, in, count);
+	CHECK(packed == count, "%zu bytes: packed %zu", count, packed);
+
+	for (size_t i = 0; i < count; i++) {
+		uint16_t word = read_9bit(out, i);
+
+		CHECK(word & 0x100, "%zu bytes: word %zu has no D/C bit", count, i);
+		CHECK((word & 0xff) == in[i], "%zu bytes: word %zu is %03x, expected %02x", count,
+		      i, word, in[i]);
+	}
+
+	CHECK(out[count / 8 * 9] == 0xa5, "%zu bytes: wrote past the packed groups", count);
+}
+
+static void test_9bit_partial_group(size_t count)
+{
+	uint8_t in[32];
+	uint8_t out[32 / 8 * 9];
+	uint16_t words[8];
+	size_t packed;
+	size_t tail;
+
+	fill_pattern(in, count, 0x5a);
+	memset(out, 0xa5, sizeof(out));
+
+	packed = st7789v_pack_9bit(out, in, count);
+	tail = count - packed;
+	CHECK(packed == count / 8 * 8, "%zu bytes: packed %zu", count, packed);
+	CHECK(out[packed / 8 * 9] == 0xa5, "%zu bytes: partial group was packed", count);
+
+	for (size_t i = 0; i < packed; i++) {
+		CHECK(read_9bit(out, i) == (0x100 | in[i]), "%zu bytes: word %zu", count, i);
+	}
+
+	memset(words, 0, sizeof(words));
+	st7789v_pack_9bit_words(words, &in[packed], tail);
+	for (size_t i = 0; i < tail; i++) {
+		CHECK(words[i] == (0x100 | in[packed + i]), "%zu bytes: tail word %zu is %03x",
+		      count, i, words[i]);
+	}
+	CHECK(tail == 0 || words[tail] == 0, "%zu bytes: wrote past the tail", count);
+}
+
+static void test_9bit_extremes(void)
+{
+	uint8_t zeros[8] = {0};
+	uint8_t ones[8];
+	uint8_t out[9];
+	static const uint8_t zeros_packed[9] = {0x80, 0x40, 0x20, 0x10, 0x08,
+						0x04, 0x02, 0x01, 0x00};
+
+	st7789v_pack_9bit(out, zeros, sizeof(zeros));
+	CHECK(memcmp(out, zeros_packed, sizeof(out)) == 0, "zero bytes keep only D/C bits");
+
+	memset(ones, 0xff, sizeof(ones));
+	st7789v_pack_9bit(out, ones, sizeof(ones));
+	for (size_t i = 0; i < sizeof(out); i++) {
+		CHECK(out[i] == 0xff, "0xff bytes: packed byte %zu is %02x", i, out[i]);
+	}
+}
+
+/* Channels truncated to their top 4 bits, as the panel drops the rest */
+static uint16_t reference_rgb444(uint16_t px)
+{
+	uint16_t r = (px >> 11) & 0x1f;
+	uint16_t g = (px >> 5) & 0x3f;
+	uint16_t b = px & 0x1f;
+
+	return ((r >> 1) << 8) | ((g >> 2) << 4) | (b >> 1);
+}
+
+static void test_rgb444_rounding(void)
+{
+	static const struct {
+		uint16_t rgb565;
+		uint16_t rgb444;
+	} vectors[] = {
+		{0x0000, 0x000}, {0xffff, 0xfff}, {0xf800, 0xf00}, {0x07e0, 0x0f0},
+		{0x001f, 0x00f}, {0x07ff, 0x0ff}, {0xf81f, 0xf0f}, {0x7bef, 0x777},
+		{0x8410, 0x888},
+		/* One step below the next nibble still truncates down */
+		{0x0861, 0x000}, {0x1082, 0x111}, {0x18e3, 0x111}, {0xf7de, 0xfff},
+	};
+	uint8_t in[4];
+	uint8_t out[3];
+
+	for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		in[0] = vectors[i].rgb565 >> 8;
+		in[1] = vectors[i].rgb565 & 0xff;
+		CHECK(st7789v_rgb565_to_rgb444(in) == vectors[i].rgb444, "%04x converts to %03x",
+		      vectors[i].rgb565, st7789v_rgb565_to_rgb444(in));
+	}
+
+	/* Every value, through the single pixel and the pixel pair path */
+	for (uint32_t px = 0; px <= 0xffff; px++) {
+		struct st7789v_rgb444_area area = {.buf = in, .width = 2, .height = 1, .pitch = 2};
+		uint16_t expected = reference_rgb444(px);
+
+		in[0] = in[2] = px >> 8;
+		in[1] = in[3] = px & 0xff;
+
+		CHECK(st7789v_rgb565_to_rgb444(in) == expected, "%04x converts to %03x",
+		      (unsigned int)px, st7789v_rgb565_to_rgb444(in));
+		CHECK(st7789v_pack_rgb444(&area, out, sizeof(out)) == 3, "%04x pair size",
+		      (unsigned int)px);
+		CHECK(out[0] == expected >> 4 && out[1] == (((expected & 0xf) << 4) | expected >> 8) &&
+			      out[2] == (expected & 0xff),
+		      "%04x pair packs to %02x %02x %02x", (unsigned int)px, out[0], out[1], out[2]);
+	}
+}
+
+/* Packs the visible pixels one by one, two per 3 bytes and a 2 byte tail */
+static size_t reference_area(uint8_t *out, const uint8_t *buf, uint16_t width, uint16_t height,
+			     uint16_t pitch)
+{
+	size_t pixels = 0;
+	size_t len = 0;
+	uint16_t first = 0;
+
+	for (uint16_t row = 0; row < height; row++) {
+		for (uint16_t col = 0; col < width; col++) {
+			const uint8_t *in = &buf[((size_t)row * pitch + col) * 2];
+			uint16_t px = reference_rgb444((uint16_t)(in[0] << 8) | in[1]);
+
+			if (pixels++ % 2 == 0) {
+				first = px;
+				continue;
+			}
+
+			out[len++] = first >> 4;
+			out[len++] = ((first & 0xf) << 4) | (px >> 8);
+			out[len++] = px & 0xff;
+		}
+	}
+
+	if (pixels % 2 != 0) {
+		out[len++] = first >> 4;
+		out[len++] = (first & 0xf) << 4;
+	}
+
+	return len;
+}
+
+static void test_rgb444_area(uint16_t width, uint16_t height, uint16_t pitch, size_t chunk)
+{
+	uint8_t buf[16 * 8 * 2];
+	uint8_t expected[16 * 8 * 2];
+	uint8_t packed[16 * 8 * 2];
+	uint8_t out[64];
+	struct st7789v_rgb444_area area = {
+		.buf = buf,
+		.width = width,
+		.height = height,
+		.pitch = pitch,
+	};
+	size_t expected_len;
+	size_t total = 0;
+	size_t len;
+	int calls = 0;
+
+	fill_pattern(buf, sizeof(buf), (uint8_t)(width * 7 + height));
+	expected_len = reference_area(expected, buf, width, height, pitch);
+
+	while ((len = st7789v_pack_rgb444(&area, out, chunk)) > 0) {
+		CHECK(len <= chunk, "%ux%u pitch %u: %zu bytes into a %zu byte chunk", width,
+		      height, pitch, len, chunk);
+		CHECK(total + len <= sizeof(packed), "%ux%u pitch %u: overflow", width, height,
+		      pitch);
+		if (len > chunk || total + len > sizeof(packed) || ++calls > 1000) {
+			return;
+		}
+		memcpy(&packed[total], out, len);
+		total += len;
+	}
+
+	CHECK(total == expected_len, "%ux%u pitch %u chunk %zu: %zu bytes, expected %zu", width,
+	      height, pitch, chunk, total, expected_len);
+	CHECK(memcmp(packed, expected, expected_len) == 0,
+	      "%ux%u pitch %u chunk %zu: packed data differs", width, height, pitch, chunk);
+	CHECK(st7789v_pack_rgb444(&area, out, chunk) == 0, "%ux%u pitch %u: not done", width,
+	      height, pitch);
+}
+
+int main(void)
+{
+	test_9bit_extremes();
+	test_9bit_groups(8, 0x00);
+	test_9bit_groups(64, 0x13);
+	test_9bit_groups(512, 0xc7);
+	for (size_t count = 0; count < 24; count++) {
+		test_9bit_partial_group(count);
+	}
+
+	test_rgb444_rounding();
+	for (uint16_t width = 1; width <= 9; width++) {
+		for (uint16_t height = 1; height <= 5; height++) {
+			static const uint16_t paddings[] = {0, 1, 2, 7};
+			static const size_t chunks[] = {ST7789V_RGB444_MIN_OUT, 4, 5, 6, 64};
+
+			for (size_t p = 0; p < sizeof(paddings) / sizeof(paddings[0]); p++) {
+				for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+					test_rgb444_area(width, height, width + paddings[p],
+							 chunks[c]);
+				}
+			}
+		}
+	}
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}